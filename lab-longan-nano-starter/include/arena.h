@@ -0,0 +1,28 @@
+#ifndef __ARENA_H
+#define __ARENA_H
+
+#include <stdint.h>
+
+// Bump allocator over the .arena SRAM region reserved by GD32VF103xB.lds.
+// Memory lives until the arena is reset to an earlier mark, typically when
+// a scene is left. Allocations are 8-byte aligned and zero-filled.
+
+typedef uint32_t ArenaMark;
+
+void Arena_Init(void);
+
+void *Arena_Alloc(uint32_t size);
+
+void Arena_Free(void *block);
+
+ArenaMark Arena_Mark(void);
+
+void Arena_Reset(ArenaMark mark);
+
+uint32_t Arena_Size(void);
+
+uint32_t Arena_Used(void);
+
+uint32_t Arena_HighWater(void);
+
+#endif
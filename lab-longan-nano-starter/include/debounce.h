@@ -0,0 +1,27 @@
+#ifndef __DEBOUNCE_H
+#define __DEBOUNCE_H
+
+#include <stdint.h>
+
+// Per-key debounce state machine. Free of hardware access so edge traces
+// can be replayed through it on the host.
+//
+// A key that changes level at time t is locked until t + dt: further edges
+// on that key are only remembered, never reported. Once the lock expires
+// Debounce_Settle() reports the level of the last edge seen during the
+// lock, if it differs. Other keys are unaffected.
+
+typedef enum { DEBOUNCE_STABLE, DEBOUNCE_LOCKED } DebounceState;
+
+typedef struct {
+  uint8_t state;   // DebounceState
+  uint8_t level;   // last reported level, 1 = pressed
+  uint8_t raw;     // last raw level seen while locked
+  uint32_t until;  // end of the lock, same clock as the edge stamps
+} DebounceKey;
+
+int Debounce_Edge(DebounceKey *key, uint8_t raw, uint32_t now, uint32_t dt);
+
+int Debounce_Settle(DebounceKey *key, uint32_t now, uint32_t dt);
+
+#endif
@@ -0,0 +1,48 @@
+/*-----------------------------------------------------------------------/
+/  Sector cache between FatFs and the card driver                        /
+/-----------------------------------------------------------------------*/
+
+#ifndef _DISKCACHE_DEFINED
+#define _DISKCACHE_DEFINED
+
+#include "diskio.h"
+
+/* Call disk_cache_trace() for every disk_read, see tools/disksim.c */
+#ifndef SD_CACHE_TRACE
+#define SD_CACHE_TRACE	0
+#endif
+
+typedef struct {
+	DWORD	sector;		/* Cached sector, CACHE_EMPTY if the line is free */
+	DWORD	stamp;		/* Access clock at the last hit, lowest is evicted first */
+	BYTE	pinned;		/* Sector lies in the range given to disk_cache_pin() */
+	BYTE	buf[FF_MAX_SS];
+} CACHELINE;
+
+#define DISK_CACHE_LINE	sizeof(CACHELINE)	/* Bytes of memory per way */
+
+typedef struct {
+	UINT	ways;		/* Lines given to disk_cache_init() */
+	UINT	pinned;		/* Lines holding pinned sectors, at most ways / 2 */
+	DWORD	hits;		/* Single sector reads served from the cache */
+	DWORD	misses;		/* Single sector reads that went to the card */
+	DWORD	bypass;		/* Sectors of multi-sector reads, never cached */
+	DWORD	evictions;	/* Valid lines replaced by another sector */
+} CACHESTATS;
+
+void disk_cache_init (void* mem, UINT size);
+void disk_cache_pin (DWORD sector, DWORD count);
+void disk_cache_invalidate (void);
+const CACHESTATS* disk_cache_stats (void);
+#if SD_CACHE_TRACE
+void disk_cache_trace (DWORD sector, UINT count);	/* Supplied by the application */
+#endif
+
+/* Card driver under the cache, tf_card.c on the target and a disk image
+   file in tools/disksim.c on the host */
+DRESULT mmc_disk_read (BYTE drv, BYTE* buff, DWORD sector, UINT count);
+#if FF_FS_READONLY == 0
+DRESULT mmc_disk_write (BYTE drv, const BYTE* buff, DWORD sector, UINT count);
+#endif
+
+#endif
@@ -0,0 +1,18 @@
+/*-----------------------------------------------------------------------/
+/  Constant time random access into large files                          /
+/-----------------------------------------------------------------------*/
+
+#ifndef _FFSEEK_DEFINED
+#define _FFSEEK_DEFINED
+
+#include "ff.h"
+
+/* CLMT items for a file in n fragments, see f_fastseek_open() */
+#define FF_CLMT_ITEMS(n)	((n) * 2 + 2)
+
+FRESULT f_fastseek_open (FIL* fp, const TCHAR* path, DWORD* clmt, UINT items);
+FRESULT f_read_at (FIL* fp, FSIZE_t ofs, void* buff, UINT btr, UINT* br);
+UINT f_fragments (FIL* fp);
+DWORD f_start_sector (FIL* fp);
+
+#endif
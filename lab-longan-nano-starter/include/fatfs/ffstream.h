@@ -0,0 +1,17 @@
+/*-----------------------------------------------------------------------/
+/  Streaming reads of large files on top of FatFs                        /
+/-----------------------------------------------------------------------*/
+
+#ifndef _FFSTREAM_DEFINED
+#define _FFSTREAM_DEFINED
+
+#include "ff.h"
+
+/* One stream at a time: the card keeps a single CMD18 open for it. The
+   FIL works with every other f_ call, f_stream_read() is f_read(). */
+FRESULT f_stream_open (FIL* fp, const TCHAR* path, BYTE* ring, UINT sectors);
+FRESULT f_stream_read (FIL* fp, void* buff, UINT btr, UINT* br);
+UINT f_stream_pump (FIL* fp, UINT n);
+FRESULT f_stream_close (FIL* fp);
+
+#endif
@@ -3,7 +3,74 @@
 
 #include "gd32v_pjt_include.h"
 #include "diskio.h"
+#include "diskcache.h"
 #include "ff.h"
 #include "systick.h"
+#include "tick.h"
+
+/* Verify the CRC16 of every received sector */
+#ifndef SD_VERIFY_CRC
+#define SD_VERIFY_CRC	1
+#endif
+
+/* Between disk_stream_begin() and disk_stream_end() a CMD18 is left open
+   after each read and CMD12 is only sent when a request does not start
+   where the last one ended. disk_stream_pump() receives the following
+   sectors into a ring buffer for the next read to copy out. */
+#ifndef SD_STREAM
+#define SD_STREAM	1
+#endif
+
+/* disk_async_read() queues a request and disk_async_poll() works through
+   the queue a few microseconds at a time, so reads can run in the frame
+   idle time. The synchronous calls finish the queue before they start. */
+#ifndef SD_ASYNC
+#define SD_ASYNC	1
+#endif
+
+/* SDREQ state */
+#define SDREQ_IDLE		0	/* Never queued */
+#define SDREQ_QUEUED	1	/* Waiting behind another request */
+#define SDREQ_BUSY		2	/* Being read */
+#define SDREQ_DONE		3	/* All sectors are in buff */
+#define SDREQ_ERROR		4	/* Failed, buff holds an unknown part */
+
+typedef struct SDREQ SDREQ;
+struct SDREQ {
+	BYTE	*buff;		/* Destination of count * 512 bytes */
+	DWORD	sector;		/* Start sector number (LBA) */
+	UINT	count;		/* Number of sectors to read */
+	void	(*done)(SDREQ *req);	/* Called by disk_async_poll() at the end, may be NULL */
+	void	*user;		/* Free for the caller */
+	volatile BYTE	state;	/* SDREQ_xxx, for callers that poll instead, SDREQ_IDLE before the first read */
+	SDREQ	*next;		/* Queue link */
+};
+
+typedef struct {
+	WORD	clock_div;	/* SCLK = PCLK1 / clock_div */
+	DWORD	clock_hz;	/* Negotiated SPI clock */
+	DWORD	crc_errors;	/* Sectors received with a bad CRC16 */
+	DWORD	timeouts;	/* Data start tokens that never came */
+	DWORD	retries;	/* mmc_disk_read attempts repeated after an error */
+	DWORD	stepdowns;	/* Clock steps dropped after repeated errors */
+	DWORD	streams;	/* CMD18 transfers opened while streaming */
+	DWORD	prefetched;	/* Sectors received by disk_stream_pump() */
+	DWORD	ring_hits;	/* Sectors copied out of the prefetch ring */
+	DWORD	side_reads;	/* Sectors read with CMD17 beside an open stream */
+	DWORD	rejects;	/* Data blocks the card did not accept on write */
+} SDSTATS;
+
+const SDSTATS* disk_stats (void);
+DWORD disk_bench (BYTE drv, BYTE *buff, DWORD sector, UINT count, UINT chunk, BYTE dma);
+#if SD_STREAM
+void disk_stream_begin (BYTE *ring, UINT sectors);
+void disk_stream_end (void);
+UINT disk_stream_pump (UINT n);
+#endif
+#if SD_ASYNC
+DRESULT disk_async_read (SDREQ *req);
+UINT disk_async_poll (UINT us);
+UINT disk_async_pending (void);
+#endif
 
 #endif
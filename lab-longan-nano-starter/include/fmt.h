@@ -0,0 +1,23 @@
+#ifndef __FMT_H
+#define __FMT_H
+
+#include <stdint.h>
+
+// Integer to text without printf. Each call writes into the caller's
+// buffer, NUL-terminates it and returns the end so calls can be chained:
+//
+//   char line[16];
+//   Fmt_Udec(Fmt_Str(line, "FPS: "), fps, 2, '0');
+//
+// width is a minimum, longer numbers are never cut. Buffers must hold the
+// widest result plus the terminator: 11 chars for decimal, 9 for hex.
+
+char *Fmt_Str(char *out, const char *s);
+
+char *Fmt_Udec(char *out, uint32_t v, int width, char pad);
+
+char *Fmt_Sdec(char *out, int32_t v, int width, char pad);
+
+char *Fmt_Hex(char *out, uint32_t v, int width);
+
+#endif
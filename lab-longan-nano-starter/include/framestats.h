@@ -0,0 +1,29 @@
+#ifndef __FRAMESTATS_H
+#define __FRAMESTATS_H
+
+#include <stdint.h>
+
+// Frames of history kept for the 1% low, must be a power of two
+#ifndef FSTAT_RING
+#define FSTAT_RING 128
+#endif
+
+// Averaging window, README asks for 0.12-0.15 s
+#ifndef FSTAT_WINDOW_MS
+#define FSTAT_WINDOW_MS 133
+#endif
+
+typedef struct {
+  uint16_t fps_min;  // slowest frame in the window
+  uint16_t fps_avg;  // frames over elapsed time in the window
+  uint16_t fps_max;  // fastest frame in the window
+  uint16_t fps_low1; // 99th percentile frame time over the whole ring
+  uint16_t entities; // mean entity count in the window
+  uint16_t frames;   // frames that went into the window
+} FrameStats;
+
+void Fstat_Push(uint32_t entity_count);
+
+const FrameStats *Fstat_Get(void);
+
+#endif
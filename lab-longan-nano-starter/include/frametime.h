@@ -0,0 +1,28 @@
+#ifndef __FRAMETIME_H
+#define __FRAMETIME_H
+
+#include <stdint.h>
+#include "profiler.h"
+
+// Two bins per octave of microseconds, the last bin also takes overflow
+#define FTIME_BINS 32
+
+typedef struct {
+  uint32_t frames;
+  uint32_t worst_us;
+  uint32_t worst_frame;                // frame number of the worst frame
+  uint32_t worst_cycles[PROF_PHASES];  // its per-phase profile
+  uint32_t bins[FTIME_BINS];
+} FrameTimeHist;
+
+void Ftime_Record(void);
+
+void Ftime_Reset(void);
+
+uint32_t Ftime_Percentile(uint32_t pct);
+
+const FrameTimeHist *Ftime_Get(void);
+
+void Ftime_Dump(void);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef __INPUT_H
+#define __INPUT_H
+
+#include <stdint.h>
+
+// Lockout after an accepted level change, the README's delta t
+#ifndef INPUT_DEBOUNCE_MS
+#define INPUT_DEBOUNCE_MS 20
+#endif
+
+// Queued events, must be a power of two
+#ifndef INPUT_QUEUE_SIZE
+#define INPUT_QUEUE_SIZE 16
+#endif
+
+typedef struct {
+  uint32_t stamp;  // low 32 bits of mtime at the edge
+  uint8_t key;     // JOY_LEFT .. BUTTON_2 from utils.h
+  uint8_t pressed; // 1 on press, 0 on release
+} InputEvent;
+
+void Input_Init(void);
+
+int Input_Poll(InputEvent *ev);
+
+void Input_Flush(void);
+
+void Input_Settle(void);
+
+uint8_t Input_Held(void);
+
+uint32_t Input_Dropped(void);
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef __LATENCY_H
+#define __LATENCY_H
+
+#include <stdint.h>
+
+// Samples kept for the rolling histogram, must be a power of two
+#ifndef LAT_WINDOW
+#define LAT_WINDOW 32
+#endif
+
+// A press that moved nothing within this long is discarded
+#define LAT_TIMEOUT_MS 200
+
+#define LAT_BINS 16 // one bin per power of two microseconds
+
+typedef struct {
+  uint32_t samples;        // completed measurements since boot
+  uint32_t last_us;        // edge to photon of the last measurement
+  uint32_t edge_tick_us;   // edge to consuming logic tick, last measurement
+  uint32_t tick_photon_us; // logic tick to player rectangle on the bus
+  uint32_t avg_us;         // mean over the window
+  uint32_t max_us;         // worst in the window
+} LatStats;
+
+void Lat_Input(uint32_t edge_stamp);
+
+void Lat_Photon(void);
+
+const LatStats *Lat_Get(void);
+
+void Lat_Dump(void);
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef __ASSETS_H
+#define __ASSETS_H
+
+#include <stdint.h>
+
+// Index of the read-only display assets defined once in src/lcd/assets.c.
+
+#define LOGO_BMP_SIZE 25600 // 160x80 RGB565, streamed by LCD_ShowLogo
+#define ASC2_1608_SIZE 1520  // 95 glyphs of 8x16
+#define HZK16_GLYPHS 7       // 16x16, 32 bytes each
+#define HZK32_GLYPHS 5       // 32x32, 128 bytes each
+
+extern const uint8_t logo_bmp[LOGO_BMP_SIZE];
+extern const uint8_t asc2_1608[ASC2_1608_SIZE];
+extern const uint8_t Hzk16[HZK16_GLYPHS * 32];
+extern const uint8_t Hzk32[HZK32_GLYPHS * 128];
+
+#endif
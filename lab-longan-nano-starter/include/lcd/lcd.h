@@ -4,6 +4,7 @@
 #include "systick.h"
 #include "stdlib.h"	
 #include "gd32vf103_gpio.h"
+#include "lcd/pixels.h"
 
 #define USE_HORIZONTAL 3  //Set horizontal or vertical screen display 0 or 1 for vertical screen 2 or 3 for horizontal screen
 #define HAS_BLK_CNTL    0
@@ -33,6 +34,11 @@ typedef unsigned long u32;
 
 #define FRAME_SIZE  25600
 
+//Pixel transactions by DMA0 channel 2 with SPI0_CFG 1, 0 for polled writes
+#ifndef LCD_PIXELS_DMA
+#define LCD_PIXELS_DMA 1
+#endif
+
 //-----------------OLED端口定义---------------- 
 #if SPI0_CFG == 1
 #define OLED_SCLK_Clr() 
@@ -41,8 +47,8 @@ typedef unsigned long u32;
 #define OLED_SDIN_Clr()
 #define OLED_SDIN_Set()
 
-#define OLED_CS_Clr() gpio_bit_reset(GPIOB,GPIO_PIN_2)     //CS PB2
-#define OLED_CS_Set() gpio_bit_set(GPIOB,GPIO_PIN_2)
+#define OLED_CS_Clr() (GPIO_BC(GPIOB)=GPIO_PIN_2)     //CS PB2
+#define OLED_CS_Set() (GPIO_BOP(GPIOB)=GPIO_PIN_2)
 #elif SPI0_CFG == 2
 #define OLED_SCLK_Clr() 
 #define OLED_SCLK_Set() 
@@ -66,8 +72,10 @@ typedef unsigned long u32;
 #define OLED_RST_Clr() gpio_bit_reset(GPIOB,GPIO_PIN_1)     //RES PB1
 #define OLED_RST_Set() gpio_bit_set(GPIOB,GPIO_PIN_1)
 
-#define OLED_DC_Clr() gpio_bit_reset(GPIOB,GPIO_PIN_0)      //DC PB0
-#define OLED_DC_Set() gpio_bit_set(GPIOB,GPIO_PIN_0)
+//CS and DC toggle on every bus write, so they poke the port registers
+//directly instead of calling into the SDK (see LCD_Writ_Bus)
+#define OLED_DC_Clr() (GPIO_BC(GPIOB)=GPIO_PIN_0)      //DC PB0
+#define OLED_DC_Set() (GPIO_BOP(GPIOB)=GPIO_PIN_0)
 
 
 #if     HAS_BLK_CNTL
@@ -100,7 +108,7 @@ void LCD_DrawRectangle(u16 x1, u16 y1, u16 x2, u16 y2,u16 color);
 void LCD_DrawCircle(u16 x0,u16 y0,u8 r,u16 color);
 void LCD_ShowChar(u16 x,u16 y,u8 num,u8 mode,u16 color);
 void LCD_ShowString(u16 x,u16 y,const u8 *p,u16 color);
-u32 mypow(u8 m,u8 n);
+void LCD_ShowText(u16 x,u16 y,const char *s,u16 color);
 void LCD_ShowNum(u16 x,u16 y,u16 num,u8 len,u16 color);
 void LCD_ShowNum1(u16 x,u16 y,float num,u8 len,u16 color);
 void LCD_ShowPicture(u16 x1,u16 y1,u16 x2,u16 y2);
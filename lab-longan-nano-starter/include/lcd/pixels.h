@@ -0,0 +1,24 @@
+#ifndef __PIXELS_H
+#define __PIXELS_H
+
+#include <stdint.h>
+
+// Pixel transaction on the LCD: the address window is set once, then any
+// number of writes and fills stream RGB565 into it with CS held low until
+// LCD_PixelsEnd. LCD_PixelsWrite returns as soon as the transfer is
+// started when it goes by DMA, so the caller can read the next pixels from
+// the card meanwhile; the buffer must stay untouched until the next
+// LCD_Pixels call, which waits for it. Bytes are sent as given, high byte
+// of each pixel first. Plain stdint types, lcd.h has u16 as unsigned int.
+
+void LCD_PixelsBegin(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2);
+
+void LCD_PixelsWrite(const uint8_t *buf, uint32_t len);
+
+void LCD_PixelsFill(uint16_t color, uint32_t count);
+
+void LCD_PixelsWait(void);
+
+void LCD_PixelsEnd(void);
+
+#endif
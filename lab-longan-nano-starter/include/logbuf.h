@@ -0,0 +1,120 @@
+#ifndef __LOGBUF_H
+#define __LOGBUF_H
+
+#include <stdint.h>
+#include "frametime.h"
+#include "profiler.h"
+
+// Telemetry log on the SD card: score records, frame-time histograms and
+// profiler samples. Off by default, the buffer and the FatFs objects take
+// about 3 KB of arena from the bullet pools.
+#ifndef LOG_ENABLE
+#define LOG_ENABLE 0
+#endif
+
+#ifndef LOG_FILE
+#define LOG_FILE "GAMELOG.BIN"
+#endif
+
+#define LOG_SECTOR 512
+
+// Write-behind buffer in sectors, full sectors go out LOG_FLUSH_SECTORS
+// at a time in one multi-block write
+#ifndef LOG_BUFFER_SECTORS
+#define LOG_BUFFER_SECTORS 4
+#endif
+#ifndef LOG_FLUSH_SECTORS
+#define LOG_FLUSH_SECTORS 2
+#endif
+
+// Card time allowed per sector written. The idle branch flushes only as
+// many sectors as fit before the next logic tick is due, none if not one.
+// A guess until calibrated: divide flush_worst from the 'w' dump by
+// LOG_FLUSH_SECTORS on the card in use.
+#ifndef LOG_SECTOR_US
+#define LOG_SECTOR_US 1500
+#endif
+
+// Sectors a new LOG_FILE is created with, one contiguous zeroed run so a
+// flush never has to allocate clusters. About two hours at the default
+// record rates, after that the file grows as usual.
+#ifndef LOG_PREALLOC_SECTORS
+#define LOG_PREALLOC_SECTORS 512
+#endif
+
+// Frames between profiler samples and between frame-time histograms
+#ifndef LOG_PROF_FRAMES
+#define LOG_PROF_FRAMES 60
+#endif
+#ifndef LOG_FTIME_FRAMES
+#define LOG_FTIME_FRAMES 3600
+#endif
+
+typedef enum {
+  LOG_PAD,   // zero fill to the end of the sector, records never straddle one
+  LOG_SCORE, // LogScore
+  LOG_FTIME, // LogFtime
+  LOG_PROF,  // LogProf
+} LogType;
+
+// Little-endian, every record starts with this header
+typedef struct {
+  uint8_t type; // LogType
+  uint8_t len;  // payload bytes after the header
+  uint16_t seq; // record number, gaps are records dropped on a full buffer
+  uint32_t ms;  // Tick_Ms when recorded
+} LogHeader;
+
+typedef struct {
+  uint32_t frame; // Sched_Stats()->frames
+  uint32_t kills; // enemies shot down since boot
+  uint32_t alive; // enemies on screen
+} LogScore;
+
+typedef struct {
+  uint32_t frames, p50_us, p99_us, worst_us;
+  uint32_t bins[FTIME_BINS]; // FrameTimeHist.bins since the last Ftime_Reset
+} LogFtime;
+
+typedef struct {
+  uint32_t frame;
+  uint32_t cycles[PROF_PHASES]; // Prof_AvgCycles over PROF_HISTORY frames
+} LogProf;
+
+typedef struct {
+  uint32_t records;       // records buffered
+  uint32_t dropped;       // records lost because every sector was full
+  uint32_t sectors;       // sectors handed to the sink
+  uint32_t writes;        // sink writes, one multi-block write each
+  uint32_t errors;        // failed sink writes, their sectors are lost
+  uint32_t syncs;         // Log_Sync calls
+  uint32_t record_cycles; // spent in Log_Record, counted in the frame
+  uint32_t flush_cycles;  // spent in Log_Flush, taken from idle time
+  uint32_t flush_worst;   // longest single Log_Flush
+} LogStats;
+
+int Log_Open(void *mem, uint32_t size);
+
+int Log_Record(LogType type, const void *payload, uint32_t len);
+
+int Log_Pending(void);
+
+void Log_Flush(uint32_t max);
+
+void Log_Sync(void);
+
+void Log_Close(void);
+
+const LogStats *Log_Stats(void);
+
+// Backing store, src/logsink.c writes LOG_FILE through FatFs on the board
+// and tools/logsim.c a host file
+int Log_SinkOpen(void);
+
+int Log_SinkWrite(const void *data, uint32_t sectors);
+
+int Log_SinkSync(void);
+
+void Log_SinkClose(void);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef __MEMSTAT_H
+#define __MEMSTAT_H
+
+#include <stdint.h>
+
+// Word written over the unused stack at boot, overwritten words are "used"
+#define MEM_STACK_PAINT 0xA5A5A5A5u
+
+typedef struct {
+  const char *name;   // pool label in the dump
+  uint32_t cap;       // elements the pool was given
+  uint32_t elem_size; // bytes per element
+} MemPool;
+
+typedef struct {
+  uint32_t boot_us;    // reset to main, including the .data copy
+  uint32_t data;       // initialised .data bytes
+  uint32_t bss;        // zeroed .bss bytes
+  uint32_t arena;      // .arena region bytes
+  uint32_t arena_used; // bytes currently allocated
+  uint32_t arena_high; // most bytes ever allocated
+  uint32_t stack;      // bytes reserved for the stack
+  uint32_t stack_high; // deepest stack use seen since Mem_PaintStack
+} MemStats;
+
+void Mem_PaintStack(void);
+
+uint32_t Mem_StackHighWater(void);
+
+void Mem_Get(MemStats *stats);
+
+void Mem_Dump(const MemPool *pools, int count);
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef __PACK_H
+#define __PACK_H
+
+#include <stdint.h>
+#include "fatfs/ffseek.h"
+
+// Asset pack on the SD card, written by tools/pack_assets.py. Sector 0
+// holds the PackHeader, the index starts at sector 1 with 16 PackEntry per
+// sector sorted by type and id, and every payload starts on a sector of its
+// own so it can be read by DMA straight into its destination. Little-endian.
+#define PACK_MAGIC 0x4B434150u // "PACK"
+#define PACK_VERSION 2
+#define PACK_SECTOR 512
+
+#ifndef PACK_FILE
+#define PACK_FILE "ASSETS.PAK"
+#endif
+
+// Cluster link map kept for the open pack, enough for 15 fragments. Only
+// a pack in one piece is read as raw sectors; one in up to 15 goes through
+// FatFs fast seek, more fragments walk the FAT chain.
+#ifndef PACK_CLMT_ITEMS
+#define PACK_CLMT_ITEMS FF_CLMT_ITEMS(15)
+#endif
+
+typedef enum {
+  PACK_SPRITE = 1,
+  PACK_LEVEL = 2,
+  PACK_IMAGE = 3, // full-screen RGB565, e.g. the logo
+  PACK_FONT = 4,
+} PackType;
+
+typedef enum {
+  PACK_RAW = 0,   // stored as is
+  PACK_RLE16 = 1, // runs of 16-bit words, see src/pack.c
+} PackComp;
+
+typedef struct {
+  uint32_t magic;        // PACK_MAGIC
+  uint16_t version;      // PACK_VERSION
+  uint16_t entry_size;   // sizeof(PackEntry)
+  uint32_t count;        // index entries
+  uint32_t index_sector; // first index sector
+  uint32_t data_sector;  // first payload sector
+  uint32_t sectors;      // length of the whole pack
+} PackHeader;
+
+typedef struct {
+  uint8_t type;      // PackType
+  uint8_t comp;      // PackComp
+  uint16_t id;
+  uint32_t sector;   // payload start, sectors from the start of the pack
+  uint32_t size;     // stored bytes
+  uint32_t raw_size; // bytes once decoded
+  uint32_t slack;    // PACK_RLE16: load buffer bytes ahead of the stored data
+  char name[12];     // source file, NUL padded
+} PackEntry;
+
+int Pack_Open(FIL *fp, const char *path, uint8_t *work);
+
+int Pack_Find(PackType type, uint16_t id, PackEntry *e);
+
+uint32_t Pack_LoadSize(const PackEntry *e);
+
+uint32_t Pack_Load(const PackEntry *e, void *buf);
+
+uint32_t Pack_Read(const PackEntry *e, uint32_t ofs, void *buf, uint32_t len);
+
+uint32_t Pack_StartSector(void);
+
+uint32_t Pack_Fragments(void);
+
+void Pack_Close(void);
+
+#endif
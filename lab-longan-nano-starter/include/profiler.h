@@ -0,0 +1,71 @@
+#ifndef __PROFILER_H
+#define __PROFILER_H
+
+#include <stdint.h>
+
+// Frames of per-phase history kept for averaging and the overlay
+#ifndef PROF_HISTORY
+#define PROF_HISTORY 8
+#endif
+
+typedef enum {
+  PROF_LOGIC, // game_tick, all catch-up ticks of a frame
+  PROF_HUD,   // fps_entity
+  PROF_DRAW,  // draw, draw_many_bullets
+  PROF_ERASE, // erase_origin, erase_many_bullets
+  PROF_STORE, // store_state, store_many_bullets
+  PROF_DISK,  // disk_async_poll and Log_Flush in frame idle time
+  PROF_IDLE,  // WFI in Sched_Idle
+  PROF_PHASES
+} ProfPhase;
+
+#ifdef HOST_BUILD
+#include <time.h>
+// Host builds count nanoseconds where the board counts cycles
+static inline uint32_t prof_cycles(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)(ts.tv_sec * 1000000000ull + ts.tv_nsec);
+}
+static inline uint32_t prof_instret(void) { return 0; }
+#else
+static inline uint32_t prof_cycles(void) {
+  uint32_t v;
+  __asm__ volatile("csrr %0, mcycle" : "=r"(v));
+  return v;
+}
+static inline uint32_t prof_instret(void) {
+  uint32_t v;
+  __asm__ volatile("csrr %0, minstret" : "=r"(v));
+  return v;
+}
+#endif
+
+// Runs the following statement or block as a named profiler scope
+#define PROF_SCOPE(phase)                                                      \
+  for (int _prof_once = (Prof_Begin(phase), 1); _prof_once;                    \
+       _prof_once = (Prof_End(phase), 0))
+
+void Prof_Init(void);
+
+void Prof_Begin(ProfPhase phase);
+
+void Prof_End(ProfPhase phase);
+
+void Prof_FrameEnd(void);
+
+uint32_t Prof_Cycles(ProfPhase phase, int frames_ago);
+
+uint32_t Prof_Instret(ProfPhase phase, int frames_ago);
+
+uint32_t Prof_AvgCycles(ProfPhase phase);
+
+const char *Prof_Name(ProfPhase phase);
+
+void Prof_ToggleOverlay(void);
+
+int Prof_OverlayOn(void);
+
+void Prof_DrawOverlay(void);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef __RAMFUNC_H
+#define __RAMFUNC_H
+
+// Functions tagged RAMFUNC execute from SRAM instead of wait-stated flash.
+// GD32VF103xB.lds places .ramfunc at the start of .data, so the startup
+// .data copy loads them together with the initialised variables. Keep the
+// tagged kernels small and free of SDK calls, or the hot loop ends up
+// fetching from flash anyway.
+//
+// Build with -D RAMFUNC_ENABLE=0 to leave everything in flash, e.g. for a
+// BENCHMARK_FRAMES comparison.
+#ifndef RAMFUNC_ENABLE
+#define RAMFUNC_ENABLE 1
+#endif
+
+#if RAMFUNC_ENABLE
+#define RAMFUNC __attribute__((section(".ramfunc")))
+#else
+#define RAMFUNC
+#endif
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef __SAMPLER_H
+#define __SAMPLER_H
+
+#include <stdint.h>
+
+// Statistical PC sampling on TIMER1, off unless enabled in the build
+#ifndef PROF_SAMPLER
+#define PROF_SAMPLER 0
+#endif
+
+#ifndef PROF_SAMPLER_HZ
+#define PROF_SAMPLER_HZ 2000
+#endif
+
+// Bounds on the sample rate. The upper keeps the ISR cost bounded, the
+// lower keeps the period of the 1 MHz counter within its 16 bits.
+#define PSAMP_MAX_HZ 10000
+#define PSAMP_MIN_HZ 16
+
+// Histogram slots, must be a power of two
+#ifndef PSAMP_SLOTS
+#define PSAMP_SLOTS 256
+#endif
+
+typedef struct {
+  uint32_t hz;           // effective sample rate
+  uint32_t samples;      // samples taken
+  uint32_t dropped;      // samples lost to a full histogram neighbourhood
+  uint64_t isr_cycles;   // cycles spent in the sampling handler
+  uint64_t span_cycles;  // cycles between Psamp_Start and the last sample
+  uint32_t overhead_ppm; // isr_cycles / span_cycles in parts per million
+} PsampStats;
+
+void Psamp_Start(uint32_t hz);
+
+void Psamp_Stop(void);
+
+void Psamp_Reset(void);
+
+const PsampStats *Psamp_Stats(void);
+
+void Psamp_Dump(void);
+
+#endif
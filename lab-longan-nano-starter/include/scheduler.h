@@ -0,0 +1,37 @@
+#ifndef __SCHEDULER_H
+#define __SCHEDULER_H
+
+#include <stdint.h>
+
+// Game logic runs at a fixed rate, rendering runs whenever logic advanced
+#ifndef SCHED_LOGIC_HZ
+#define SCHED_LOGIC_HZ 60
+#endif
+
+// Most logic ticks run back to back before the backlog is dropped
+#ifndef SCHED_MAX_CATCHUP
+#define SCHED_MAX_CATCHUP 4
+#endif
+
+typedef struct {
+  uint32_t frames;          // rendered frames since Sched_Init
+  uint32_t logic_ticks;     // logic ticks run since Sched_Init
+  uint32_t dropped_ticks;   // ticks discarded by the catch-up limit
+  uint32_t last_frame_time; // mtime ticks between the last two frames
+  uint32_t last_idle_time;  // mtime ticks spent in WFI before the last frame
+  uint8_t last_catchup;     // logic ticks run for the last frame
+} SchedStats;
+
+void Sched_Init(void);
+
+int Sched_Poll(void);
+
+void Sched_Idle(void);
+
+uint32_t Sched_TimeLeft(void);
+
+void Sched_FrameDone(void);
+
+const SchedStats *Sched_Stats(void);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef __SERIAL_H
+#define __SERIAL_H
+
+#include <stdint.h>
+
+#ifndef SERIAL_BAUDRATE
+#define SERIAL_BAUDRATE 115200U
+#endif
+
+void Serial_Init(void);
+
+void Serial_PutChar(char c);
+
+void Serial_Write(const char *s);
+
+void Serial_WriteHex(uint32_t v);
+
+void Serial_WriteDec(uint32_t v);
+
+int Serial_GetChar(void);
+
+#endif
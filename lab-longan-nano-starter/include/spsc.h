@@ -0,0 +1,45 @@
+#ifndef __SPSC_H
+#define __SPSC_H
+
+#include <stdint.h>
+
+// Single-producer/single-consumer ring of fixed-size records.
+//
+// The producer only writes head, the consumer only writes tail, so neither
+// side needs to mask interrupts or take a lock. Capacity must be a power of
+// two; the indices run freely and are masked on access, so a full ring
+// holds all SPSC_CAPACITY records.
+//
+// Release stores on the index order the record copy before the publish,
+// acquire loads order the other side's index before the record access. GCC
+// lowers both to RISC-V fence instructions; on a host they are the usual
+// C11 memory orders, so the same header works under pthreads.
+
+#define SPSC_DECLARE(name, type, capacity)                                     \
+  typedef char name##_pow2_check[((capacity) & ((capacity)-1)) ? -1 : 1];      \
+  static type name##_buf[capacity];                                            \
+  static volatile uint32_t name##_head, name##_tail;                           \
+                                                                               \
+  static inline int name##_push(const type *rec) {                             \
+    uint32_t head = name##_head;                                               \
+    if (head - __atomic_load_n(&name##_tail, __ATOMIC_ACQUIRE) == (capacity))  \
+      return 0;                                                                \
+    name##_buf[head & ((capacity)-1)] = *rec;                                  \
+    __atomic_store_n(&name##_head, head + 1, __ATOMIC_RELEASE);                \
+    return 1;                                                                  \
+  }                                                                            \
+                                                                               \
+  static inline int name##_pop(type *rec) {                                    \
+    uint32_t tail = name##_tail;                                               \
+    if (__atomic_load_n(&name##_head, __ATOMIC_ACQUIRE) == tail)               \
+      return 0;                                                                \
+    *rec = name##_buf[tail & ((capacity)-1)];                                  \
+    __atomic_store_n(&name##_tail, tail + 1, __ATOMIC_RELEASE);                \
+    return 1;                                                                  \
+  }                                                                            \
+                                                                               \
+  static inline uint32_t name##_count(void) {                                  \
+    return __atomic_load_n(&name##_head, __ATOMIC_ACQUIRE) - name##_tail;      \
+  }
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef __TICK_H
+#define __TICK_H
+
+#include <stdint.h>
+
+// Shared 1 kHz tick on TIMER2. SD card timeouts, delay_1ms, the input
+// debounce lockout and the Sched_Idle wake-up all run from it.
+#define TICK_HZ 1000
+
+// Handlers called from the tick interrupt, in registration order
+#ifndef TICK_MAX_HOOKS
+#define TICK_MAX_HOOKS 4
+#endif
+
+typedef void (*TickHook)(void);
+
+void Tick_Init(void);
+
+uint32_t Tick_Ms(void);
+
+int Tick_Register(TickHook hook);
+
+#endif
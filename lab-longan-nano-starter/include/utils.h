@@ -15,6 +15,11 @@ enum {
 
 int Get_Button(int ch);
 
+// Masks from the last Input_Snapshot, bit n is button n of the enum above
+extern uint8_t input_held, input_pressed, input_released;
+
+uint32_t Input_Snapshot(void);
+
 int Get_BOOT0(void);
 
 #endif
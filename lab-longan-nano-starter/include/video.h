@@ -0,0 +1,94 @@
+#ifndef __VIDEO_H
+#define __VIDEO_H
+
+#include <stdint.h>
+#include "fatfs/ffseek.h"
+
+// Full-screen clip on the SD card, written by tools/video_encode.py.
+// Sector 0 holds the VideoHeader, the frame index starts at sector 1 with
+// 64 VideoFrame per sector, and every frame starts on a sector of its own.
+// Pixels are RGB565 high byte first, the order the LCD takes them; the
+// rest is little-endian.
+#define VIDEO_MAGIC 0x31444956u // "VID1"
+#define VIDEO_VERSION 1
+#define VIDEO_SECTOR 512
+
+#ifndef VIDEO_FILE
+#define VIDEO_FILE "INTRO.VID"
+#endif
+
+// Play VIDEO_FILE as a cutscene between the menu and the game; the 'v'
+// serial command plays it in any build
+#ifndef VIDEO_INTRO
+#define VIDEO_INTRO 0
+#endif
+
+// Sectors in each of the two ping-pong buffers: one is read from the card
+// while the other goes to the LCD by DMA. A 160x80 key frame is 50 sectors.
+#ifndef VIDEO_BUF_SECTORS
+#define VIDEO_BUF_SECTORS 4
+#endif
+
+// Memory Video_Open takes: an index sector and the two buffers
+#define VIDEO_MEM ((1 + 2 * VIDEO_BUF_SECTORS) * VIDEO_SECTOR)
+
+// Cluster link map kept for the open clip, as for the asset pack
+#ifndef VIDEO_CLMT_ITEMS
+#define VIDEO_CLMT_ITEMS FF_CLMT_ITEMS(15)
+#endif
+
+typedef enum {
+  VIDEO_KEY = 0,   // width * height pixels, row by row
+  VIDEO_DELTA = 1, // spans changed since the previous frame, see src/video.c
+} VideoFrameType;
+
+typedef struct {
+  uint32_t magic;        // VIDEO_MAGIC
+  uint16_t version;      // VIDEO_VERSION
+  uint16_t frame_size;   // sizeof(VideoFrame)
+  uint16_t width;        // at most 256, from the top left corner
+  uint16_t height;
+  uint16_t fps;          // target rate
+  uint16_t key_interval; // frames between forced key frames, 0 if none
+  uint32_t frames;
+  uint32_t index_sector; // first index sector
+  uint32_t data_sector;  // first frame sector
+  uint32_t sectors;      // length of the whole clip
+} VideoHeader;
+
+typedef struct {
+  uint32_t sector;  // frame start, sectors from the start of the clip
+  uint16_t sectors; // length, 0 for a frame with nothing changed
+  uint8_t type;     // VideoFrameType
+  uint8_t pad;
+} VideoFrame;
+
+typedef struct {
+  uint32_t frames;   // in the clip
+  uint32_t shown;    // frames sent to the LCD
+  uint32_t dropped;  // skipped to catch up, always up to a key frame
+  uint32_t late;     // shown after their time, a delta cannot be skipped
+  uint32_t keys;     // key frames among the shown ones
+  uint32_t last;     // index of the frame on the screen
+  uint32_t sectors;  // read from the card
+  uint32_t ms;       // from the first frame to the end of the last
+  uint64_t cycles;   // prof_cycles over the same time
+  uint64_t read_cycles; // of which waiting for the card
+  uint64_t wait_cycles; // of which waiting for the LCD DMA
+  uint64_t idle_cycles; // of which ahead of time, asleep
+} VideoStats;
+
+// Called between frames, returns nonzero to stop the clip
+typedef int (*VideoSkip)(void);
+
+int Video_Open(FIL *fp, const char *path, uint8_t *mem);
+
+const VideoHeader *Video_Header(void);
+
+int Video_Play(VideoSkip skip, VideoStats *st);
+
+uint32_t Video_StartSector(void);
+
+void Video_Close(void);
+
+#endif
@@ -0,0 +1,53 @@
+#include "arena.h"
+#include <string.h>
+
+extern char __arena_start[], __arena_end[];
+
+static uint32_t top;        // bytes in use
+static uint32_t last;       // offset of the most recent allocation
+static uint32_t high_water; // largest top seen since boot
+
+void Arena_Init(void) { top = last = high_water = 0; }
+
+/**
+ * @param[in] size bytes, rounded up to a multiple of 8
+ * @returns zero-filled block, or NULL if the arena cannot fit it
+ * */
+void *Arena_Alloc(uint32_t size) {
+  char *block = __arena_start + top;
+
+  size = (size + 7) & ~7u;
+  if (size > Arena_Size() - top)
+    return NULL;
+  memset(block, 0, size);
+  last = top;
+  top += size;
+  if (top > high_water)
+    high_water = top;
+  return block;
+}
+
+/**
+ * Give back the most recent allocation, e.g. a FatFs work buffer. Any
+ * other block is only reclaimed by Arena_Reset.
+ * */
+void Arena_Free(void *block) {
+  if (block && (char *)block == __arena_start + last)
+    top = last;
+}
+
+/**
+ * @returns a mark to return to with Arena_Reset when the scene ends
+ * */
+ArenaMark Arena_Mark(void) { return top; }
+
+void Arena_Reset(ArenaMark mark) {
+  if (mark <= top)
+    top = last = mark;
+}
+
+uint32_t Arena_Size(void) { return __arena_end - __arena_start; }
+
+uint32_t Arena_Used(void) { return top; }
+
+uint32_t Arena_HighWater(void) { return high_water; }
@@ -0,0 +1,43 @@
+#include "debounce.h"
+
+static int expired(const DebounceKey *key, uint32_t now) {
+  return (int32_t)(now - key->until) >= 0; // wrap-safe
+}
+
+static int accept(DebounceKey *key, uint8_t raw, uint32_t now, uint32_t dt) {
+  key->level = raw;
+  key->raw = raw;
+  key->until = now + dt;
+  key->state = DEBOUNCE_LOCKED;
+  return 1;
+}
+
+/**
+ * Feed a raw edge.
+ * @returns 1 if the key changed level and the change should be reported
+ * */
+int Debounce_Edge(DebounceKey *key, uint8_t raw, uint32_t now, uint32_t dt) {
+  if (key->state == DEBOUNCE_LOCKED) {
+    if (!expired(key, now)) {
+      key->raw = raw;
+      return 0;
+    }
+    key->state = DEBOUNCE_STABLE;
+  }
+  if (raw == key->level)
+    return 0;
+  return accept(key, raw, now, dt);
+}
+
+/**
+ * Release an expired lock, reporting a change that happened during it.
+ * @returns 1 if the key changed level and the change should be reported
+ * */
+int Debounce_Settle(DebounceKey *key, uint32_t now, uint32_t dt) {
+  if (key->state != DEBOUNCE_LOCKED || !expired(key, now))
+    return 0;
+  key->state = DEBOUNCE_STABLE;
+  if (key->raw == key->level)
+    return 0;
+  return accept(key, key->raw, now, dt);
+}
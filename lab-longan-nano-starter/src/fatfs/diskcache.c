@@ -0,0 +1,251 @@
+/*------------------------------------------------------------------------*/
+/* N-way LRU sector cache for FatFs                                       */
+/*------------------------------------------------------------------------*/
+/* disk_read() and disk_write() live here and pass through to the card
+/  driver (mmc_disk_read/mmc_disk_write). Single sector reads, which is
+/  how FatFs walks FAT chains and directories, are cached in a fully
+/  associative set of lines with least-recently-used replacement. Multi-
+/  sector reads are file data streamed into the caller's buffer and are
+/  not cached, so a long f_read() does not flush the FAT out.
+/
+/  Sectors inside the range given to disk_cache_pin() (the FAT) are kept
+/  in preference: up to half of the lines may hold pinned sectors, and
+/  those are only replaced by other pinned sectors.
+/
+/  Until disk_cache_init() gets memory every call goes straight through.
+/-------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "fatfs/diskcache.h"
+
+#define CACHE_EMPTY	0xFFFFFFFF	/* Sector number of a free line */
+
+static
+CACHELINE* Lines;		/* Cache memory, NULL when disabled */
+
+static
+DWORD Clock;			/* Access counter for the LRU stamps */
+
+static
+DWORD PinFirst, PinCount;	/* Pinned sector range */
+
+static
+CACHESTATS Stats;
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Set up the cache                                                      */
+/*-----------------------------------------------------------------------*/
+
+void disk_cache_init (
+	void* mem,		/* Line memory, NULL to disable the cache */
+	UINT size		/* Bytes at mem, DISK_CACHE_LINE per way */
+)
+{
+	memset(&Stats, 0, sizeof Stats);
+	Stats.ways = mem ? size / DISK_CACHE_LINE : 0;
+	Lines = Stats.ways ? mem : 0;
+	PinFirst = PinCount = 0;
+	disk_cache_invalidate();
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Drop every cached sector (card changed or re-initialized)             */
+/*-----------------------------------------------------------------------*/
+
+void disk_cache_invalidate (void)
+{
+	UINT i;
+
+
+	for (i = 0; i < Stats.ways; i++) {
+		Lines[i].sector = CACHE_EMPTY;
+		Lines[i].pinned = 0;
+	}
+	Stats.pinned = 0;
+	Clock = 0;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Prefer a sector range, usually fs->fatbase and fs->fsize after mount  */
+/*-----------------------------------------------------------------------*/
+
+static
+BYTE is_pinned (
+	DWORD sector
+)
+{
+	/* One way caches without pinning, at least one line stays unpinned */
+	return Stats.ways >= 2 && sector - PinFirst < PinCount;
+}
+
+
+void disk_cache_pin (
+	DWORD sector,	/* First sector to keep */
+	DWORD count		/* Number of sectors, 0 to unpin */
+)
+{
+	UINT i;
+
+
+	PinFirst = sector;
+	PinCount = count;
+	Stats.pinned = 0;
+	for (i = 0; i < Stats.ways; i++) {
+		Lines[i].pinned = Lines[i].sector != CACHE_EMPTY && is_pinned(Lines[i].sector)
+			&& Stats.pinned < Stats.ways / 2;	/* Keep the limit find_victim() relies on */
+		Stats.pinned += Lines[i].pinned;
+	}
+}
+
+
+const CACHESTATS* disk_cache_stats (void)
+{
+	return &Stats;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Line lookup and replacement                                           */
+/*-----------------------------------------------------------------------*/
+
+static
+CACHELINE* find_line (
+	DWORD sector
+)
+{
+	UINT i;
+
+
+	for (i = 0; i < Stats.ways; i++) {
+		if (Lines[i].sector == sector) return &Lines[i];
+	}
+	return 0;
+}
+
+
+static
+CACHELINE* find_victim (	/* Free line, else the least recently used one of the class */
+	BYTE pin		/* The incoming sector is pinned */
+)
+{
+	CACHELINE *lp, *victim = 0;
+	BYTE cls;
+	UINT i;
+
+
+	/* Replace a pinned line only with a pinned sector once the pinned
+	   share is full, anything else replaces an unpinned line */
+	cls = pin && Stats.pinned >= Stats.ways / 2;
+	for (i = 0; i < Stats.ways; i++) {
+		lp = &Lines[i];
+		if (lp->sector == CACHE_EMPTY) return lp;
+		if (lp->pinned != cls) continue;
+		if (!victim || lp->stamp < victim->stamp) victim = lp;
+	}
+	return victim;
+}
+
+
+static
+void drop_line (
+	CACHELINE* lp
+)
+{
+	if (lp->sector == CACHE_EMPTY) return;
+	Stats.pinned -= lp->pinned;
+	lp->sector = CACHE_EMPTY;
+	lp->pinned = 0;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Read sector(s)                                                        */
+/*-----------------------------------------------------------------------*/
+
+DRESULT disk_read (
+	BYTE drv,		/* Physical drive number (0) */
+	BYTE *buff,		/* Pointer to the data buffer to store read data */
+	DWORD sector,	/* Start sector number (LBA) */
+	UINT count		/* Number of sectors to read (1..128) */
+)
+{
+	CACHELINE *lp;
+	DRESULT res;
+	BYTE pin;
+
+
+#if SD_CACHE_TRACE
+	disk_cache_trace(sector, count);
+#endif
+	if (!Lines || drv) return mmc_disk_read(drv, buff, sector, count);
+
+	if (count != 1) {
+		Stats.bypass += count;
+		return mmc_disk_read(drv, buff, sector, count);
+	}
+
+	lp = find_line(sector);
+	if (lp) {
+		Stats.hits++;
+	} else {
+		Stats.misses++;
+		pin = is_pinned(sector);
+		lp = find_victim(pin);
+		if (lp->sector != CACHE_EMPTY) Stats.evictions++;
+		if (!lp->pinned && Stats.pinned >= Stats.ways / 2) pin = 0;	/* Free line, pinned share full */
+		drop_line(lp);
+		res = mmc_disk_read(drv, lp->buf, sector, 1);
+		if (res != RES_OK) return res;
+		lp->sector = sector;
+		lp->pinned = pin;
+		Stats.pinned += pin;
+	}
+	lp->stamp = ++Clock;
+	memcpy(buff, lp->buf, FF_MAX_SS);
+
+	return RES_OK;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Write sector(s), written through to the card                          */
+/*-----------------------------------------------------------------------*/
+
+#if FF_FS_READONLY == 0
+DRESULT disk_write (
+	BYTE drv,			/* Physical drive number (0) */
+	const BYTE *buff,	/* Ponter to the data to write */
+	DWORD sector,		/* Start sector number (LBA) */
+	UINT count			/* Number of sectors to write (1..128) */
+)
+{
+	CACHELINE *lp;
+	DRESULT res;
+	UINT i;
+
+
+	res = mmc_disk_write(drv, buff, sector, count);
+	if (!Lines || drv) return res;
+
+	for (i = 0; i < Stats.ways; i++) {	/* Keep cached copies in step with the card */
+		lp = &Lines[i];
+		if (lp->sector == CACHE_EMPTY || lp->sector - sector >= count) continue;
+		if (res == RES_OK) {
+			memcpy(lp->buf, buff + (lp->sector - sector) * FF_MAX_SS, FF_MAX_SS);
+		} else {
+			drop_line(lp);	/* Card contents unknown after a failed write */
+		}
+	}
+
+	return res;
+}
+#endif
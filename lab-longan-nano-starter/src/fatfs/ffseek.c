@@ -0,0 +1,104 @@
+/*------------------------------------------------------------------------*/
+/* Fast seek over a cluster link map                                      */
+/*------------------------------------------------------------------------*/
+/* A plain f_lseek() follows the FAT chain from the first cluster, one
+/  get_fat() per cluster and a FAT sector read every 128 or 256 of them,
+/  so a seek near the end of a 4 MB file costs more than the data read.
+/  f_fastseek_open() walks the chain once and keeps it as a cluster link
+/  map table (CLMT): a length and start cluster per contiguous fragment.
+/  Later seeks look the cluster up in that table without touching the FAT,
+/  the cost depends on the fragment count only.
+/
+/  The table belongs to the caller and must live until the file is
+/  closed. The file is read only; FatFs does not extend a fast seek file.
+/-------------------------------------------------------------------------*/
+
+#include "fatfs/ffseek.h"
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Open a file and build its CLMT                                        */
+/*-----------------------------------------------------------------------*/
+
+FRESULT f_fastseek_open (
+	FIL* fp,			/* Pointer to the blank file object */
+	const TCHAR* path,	/* Pointer to the file name */
+	DWORD* clmt,		/* CLMT buffer, FF_CLMT_ITEMS(fragments) DWORDs */
+	UINT items			/* Size of the buffer in items */
+)
+{
+	FRESULT res;
+
+
+	res = f_open(fp, path, FA_READ);
+	if (res != FR_OK) return res;
+
+	clmt[0] = items;
+	fp->cltbl = clmt;
+	res = f_lseek(fp, CREATE_LINKMAP);
+	if (res == FR_NOT_ENOUGH_CORE) {
+		/* Too fragmented for the table: the file stays open and seeks
+		   walk the chain, clmt[0] has the items it would take */
+		fp->cltbl = 0;
+	} else if (res != FR_OK) {
+		f_close(fp);
+	}
+	return res;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Read at an absolute offset                                            */
+/*-----------------------------------------------------------------------*/
+
+FRESULT f_read_at (
+	FIL* fp, 		/* Pointer to the file object */
+	FSIZE_t ofs,	/* Offset from the top of the file */
+	void* buff,		/* Pointer to data buffer */
+	UINT btr,		/* Number of bytes to read */
+	UINT* br		/* Pointer to number of bytes read */
+)
+{
+	FRESULT res;
+
+
+	*br = 0;
+	if (f_tell(fp) != ofs) {	/* Sequential reads skip the seek */
+		res = f_lseek(fp, ofs);
+		if (res != FR_OK) return res;
+	}
+	return f_read(fp, buff, btr, br);
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Number of fragments in the CLMT, 0 without fast seek                  */
+/*-----------------------------------------------------------------------*/
+
+UINT f_fragments (
+	FIL* fp		/* Pointer to the file object */
+)
+{
+	return fp->cltbl ? (fp->cltbl[0] - 2) / 2 : 0;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* First sector of a file in one piece, for raw disk_read access         */
+/*-----------------------------------------------------------------------*/
+
+DWORD f_start_sector (	/* Return value: LBA of the file, 0 if not contiguous */
+	FIL* fp		/* Pointer to the file object */
+)
+{
+	FATFS *fs = fp->obj.fs;
+
+
+	/* One fragment in the CLMT: the whole file follows its first cluster */
+	if (!fp->cltbl || fp->cltbl[0] != FF_CLMT_ITEMS(1) || fp->obj.sclust < 2) return 0;
+	return fs->database + (fp->obj.sclust - 2) * fs->csize;
+}
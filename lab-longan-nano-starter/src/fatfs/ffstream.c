@@ -0,0 +1,95 @@
+/*------------------------------------------------------------------------*/
+/* Streaming reads of large files                                         */
+/*------------------------------------------------------------------------*/
+/* f_read() of a contiguous file asks for sequential sectors, which the
+/  card driver serves from one open CMD18 while the stream is open. Call
+/  f_stream_pump() when there is time to spare (frame idle) so the next
+/  f_stream_read() finds its sectors already in the ring.
+/-------------------------------------------------------------------------*/
+
+#include "fatfs/ffstream.h"
+#include "fatfs/tf_card.h"
+
+/* With SD_STREAM 0 these are plain f_open/f_read/f_close */
+
+/*-----------------------------------------------------------------------*/
+/* Open a file for streaming                                             */
+/*-----------------------------------------------------------------------*/
+
+FRESULT f_stream_open (
+	FIL* fp,			/* Pointer to the blank file object */
+	const TCHAR* path,	/* Pointer to the file name */
+	BYTE* ring,			/* Prefetch buffer of sectors * 512 bytes, NULL for none */
+	UINT sectors		/* Ring size in sectors */
+)
+{
+	FRESULT res;
+
+
+	res = f_open(fp, path, FA_READ);
+#if SD_STREAM
+	if (res == FR_OK) disk_stream_begin(ring, sectors);
+#else
+	(void)ring; (void)sectors;
+#endif
+	return res;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Read data, same contract as f_read()                                  */
+/*-----------------------------------------------------------------------*/
+
+FRESULT f_stream_read (
+	FIL* fp, 	/* Pointer to the file object */
+	void* buff,	/* Pointer to data buffer */
+	UINT btr,	/* Number of bytes to read */
+	UINT* br	/* Pointer to number of bytes read */
+)
+{
+	/* Whole sectors go straight into buff with one disk_read, partial
+	   ones through fp->buf, both follow on from the open CMD18 */
+	return f_read(fp, buff, btr, br);
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Prefetch ahead of the read pointer                                    */
+/*-----------------------------------------------------------------------*/
+
+UINT f_stream_pump (	/* Return value: sectors received */
+	FIL* fp,	/* Pointer to the file object */
+	UINT n		/* Most sectors to receive in this call */
+)
+{
+#if SD_STREAM
+	FSIZE_t left;
+
+
+	/* Stop near the end of the file, the ring may already hold a few */
+	left = (f_size(fp) - f_tell(fp) + FF_MAX_SS - 1) / FF_MAX_SS;
+	if (n > left) n = (UINT)left;
+	return n ? disk_stream_pump(n) : 0;
+#else
+	(void)fp; (void)n;
+	return 0;
+#endif
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Close the stream and the file                                         */
+/*-----------------------------------------------------------------------*/
+
+FRESULT f_stream_close (
+	FIL* fp		/* Pointer to the file object */
+)
+{
+#if SD_STREAM
+	disk_stream_end();
+#endif
+	return f_close(fp);
+}
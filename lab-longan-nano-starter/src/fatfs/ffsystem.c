@@ -9,6 +9,8 @@
 
 #if FF_USE_LFN == 3	/* Dynamic memory allocation */
 
+#include "arena.h"
+
 /*------------------------------------------------------------------------*/
 /* Allocate a memory block                                                */
 /*------------------------------------------------------------------------*/
@@ -17,7 +19,7 @@ void* ff_memalloc (	/* Returns pointer to the allocated memory block (null if no
 	UINT msize		/* Number of bytes to allocate */
 )
 {
-	return malloc(msize);	/* Allocate a new memory block with POSIX API */
+	return Arena_Alloc(msize);	/* Allocate from the scene arena */
 }
 
 
@@ -29,7 +31,7 @@ void ff_memfree (
 	void* mblock	/* Pointer to the memory block to free (nothing to do if null) */
 )
 {
-	free(mblock);	/* Free the memory block with POSIX API */
+	Arena_Free(mblock);	/* Only the most recent block is reclaimed, FatFs frees in LIFO order */
 }
 
 #endif
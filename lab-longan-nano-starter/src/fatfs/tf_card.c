@@ -1,7 +1,21 @@
+#include <string.h>
 #include "fatfs/tf_card.h"
 
-#define FCLK_SLOW() { SPI_CTL0(SPI1) = (SPI_CTL0(SPI1) & ~0x38) | 0x28; }	/* Set SCLK = PCLK2 / 64 */
-#define FCLK_FAST() { SPI_CTL0(SPI1) = (SPI_CTL0(SPI1) & ~0x38) | 0x00; }	/* Set SCLK = PCLK2 / 2 */
+#define FCLK_SET(psc) { SPI_CTL0(SPI1) = (SPI_CTL0(SPI1) & ~0x38) | ((psc) << 3); }	/* Set SCLK = PCLK1 / (2 << psc) */
+#define FCLK_SLOW() FCLK_SET(PSC_SLOW)	/* Set SCLK = PCLK1 / 64 */
+#define PSC_SLOW	5
+
+/* After identification the clock is stepped up from PCLK1/32 towards
+   PCLK1/2. A step is kept only if SD_PROBE_READS reads of sector 0 all
+   arrive with a valid CRC16 and match the copy read at the slow clock.
+   SD_ERR_STEPDOWN failed reads in a row drop one step at run time. */
+#ifndef SD_PROBE_READS
+#define SD_PROBE_READS	4
+#endif
+#ifndef SD_ERR_STEPDOWN
+#define SD_ERR_STEPDOWN	3
+#endif
+#define SD_READ_RETRIES	1	/* Extra attempts of a failed mmc_disk_read */
 
 // #define FCLK_SLOW()
 // #define FCLK_FAST()
@@ -9,6 +23,27 @@
 #define CS_HIGH() PB_OUT(12,1)
 #define CS_LOW() PB_OUT(12,0)
 
+/* Data blocks are received by DMA0 CH3 (SPI1_RX) while CH4 (SPI1_TX)
+   clocks out 0xFF from a fixed source. Set SD_USE_DMA to 0 to always
+   poll byte by byte. */
+#ifndef SD_USE_DMA
+#define SD_USE_DMA	1
+#endif
+#define SD_DMA_MIN	32		/* Shorter transfers (CSD, SD status) are polled */
+#define SD_DMA_TIMEOUT	100	/* [ms] DMA stall before falling back to polling */
+
+/* While streaming (SD_STREAM) CS# stays low as long as a CMD18 is open */
+#define STREAM_IDLE	0xFFFFFFFF	/* StreamNext when no CMD18 is open */
+#define STREAM_GAP	2		/* Sectors read through rather than restarting the stream */
+
+/* Asynchronous read states, one step of each takes microseconds */
+#define AS_IDLE		0	/* Nothing in flight */
+#define AS_READY	1	/* Card selected, waiting for it to release DO */
+#define AS_TOKEN	2	/* Command sent, waiting for the data start token */
+#define AS_DATA		3	/* Block arriving by DMA or in polled slices */
+#define AS_POLL_BYTES	64	/* Bytes per step when the block is polled */
+#define MS_TICKS(ms)	((uint64_t)SystemCoreClock / 4000 * (ms))	/* mtime ticks */
+
 /*--------------------------------------------------------------------------
 
    Module Private Functions
@@ -40,14 +75,75 @@
 static volatile
 DSTATUS Stat = STA_NOINIT;	/* Physical drive status */
 
-// static volatile
-// UINT Timer1, Timer2;	/* 1kHz decrement timer stopped at zero (disk_timerproc()) */
 static volatile
 UINT delay_timer1, delay_timer2;        	/* 1kHz decrement timer stopped at zero (disk_timerproc()) */
 
 static
 BYTE CardType;			/* Card type flags */
 
+static
+BYTE ClockPsc = PSC_SLOW;	/* Prescaler in use, see FCLK_SET() */
+
+static
+BYTE ErrRun;			/* Failed reads in a row */
+
+static
+SDSTATS Stats;			/* Clock and error counters for disk_stats() */
+
+#if SD_STREAM
+static
+BYTE Streaming;			/* Inside disk_stream_begin/end */
+
+static
+DWORD StreamNext = STREAM_IDLE;	/* LBA the open CMD18 delivers next */
+
+static
+DWORD StreamResume = STREAM_IDLE;	/* LBA to reopen the CMD18 at after a side read */
+
+static
+DWORD SideNext = STREAM_IDLE;	/* LBA after the last side read */
+
+static
+BYTE *Ring;				/* Prefetch ring of RingSize sectors */
+
+static
+UINT RingSize, RingHead, RingCount;	/* Slots, first filled slot, filled slots */
+
+static
+DWORD RingSector;		/* LBA held in slot RingHead */
+#endif
+
+#if SD_ASYNC
+static
+SDREQ *AsyncHead, *AsyncTail;	/* Request queue, the head is in flight */
+
+static
+BYTE AsyncState = AS_IDLE;
+
+static
+UINT AsyncSector;		/* Sectors of the head request finished */
+
+static
+UINT AsyncByte;			/* Bytes of a polled block received */
+
+static
+uint64_t AsyncDeadline;	/* mtime at which the current wait fails */
+#endif
+
+static
+const WORD Crc16Tbl[16] = {	/* CRC16-CCITT (x^16+x^12+x^5+1), one nibble at a time */
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+#if SD_USE_DMA
+static
+BYTE DmaOn = 1;			/* Cleared if a DMA transfer stalls, or by disk_bench() */
+
+static
+const BYTE DmaFill = 0xFF;	/* TX source while receiving */
+#endif
+
 
 /*-----------------------------------------------------------------------*/
 /* SPI controls (Platform dependent)                                     */
@@ -61,6 +157,9 @@ void init_spi(void)
 
     rcu_periph_clock_enable(RCU_GPIOB);
     rcu_periph_clock_enable(RCU_SPI1);
+#if SD_USE_DMA
+    rcu_periph_clock_enable(RCU_DMA0);
+#endif
 
     /* SPI1_SCK(PB13), SPI1_MISO(PB14) and SPI1_MOSI(PB15) GPIO pin configuration */
     gpio_init(GPIOB, GPIO_MODE_AF_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_13 | GPIO_PIN_15);
@@ -100,19 +199,124 @@ BYTE xchg_spi (
 }
 
 
+#if SD_USE_DMA
+/* Start receiving a block by DMA */
+static
+void dma_rx_start (
+	BYTE *buff,		/* Pointer to data buffer */
+	UINT btr		/* Number of bytes to receive */
+)
+{
+	dma_parameter_struct dma_init_struct;
+
+	dma_struct_para_init(&dma_init_struct);
+	dma_init_struct.periph_addr  = (uint32_t)&SPI_DATA(SPI1);
+	dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_8BIT;
+	dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+	dma_init_struct.memory_width = DMA_MEMORY_WIDTH_8BIT;
+	dma_init_struct.number       = btr;
+
+	/* RX outranks TX so no received byte is overwritten */
+	dma_deinit(DMA0, DMA_CH3);
+	dma_init_struct.memory_addr  = (uint32_t)buff;
+	dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+	dma_init_struct.direction    = DMA_PERIPHERAL_TO_MEMORY;
+	dma_init_struct.priority     = DMA_PRIORITY_ULTRA_HIGH;
+	dma_init(DMA0, DMA_CH3, &dma_init_struct);
+
+	dma_deinit(DMA0, DMA_CH4);
+	dma_init_struct.memory_addr  = (uint32_t)&DmaFill;
+	dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_DISABLE;
+	dma_init_struct.direction    = DMA_MEMORY_TO_PERIPHERAL;
+	dma_init_struct.priority     = DMA_PRIORITY_HIGH;
+	dma_init(DMA0, DMA_CH4, &dma_init_struct);
+
+	(void)SPI_DATA(SPI1);	/* Drop a stale byte so RX starts aligned */
+	dma_channel_enable(DMA0, DMA_CH3);
+	dma_channel_enable(DMA0, DMA_CH4);
+	spi_dma_enable(SPI1, SPI_DMA_RECEIVE);
+	spi_dma_enable(SPI1, SPI_DMA_TRANSMIT);
+}
+
+
+/* Release the channels after a block, finished or not */
+static
+void dma_rx_stop (void)
+{
+	spi_dma_disable(SPI1, SPI_DMA_TRANSMIT);
+	spi_dma_disable(SPI1, SPI_DMA_RECEIVE);
+	dma_channel_disable(DMA0, DMA_CH4);
+	dma_channel_disable(DMA0, DMA_CH3);
+	dma_flag_clear(DMA0, DMA_CH3, DMA_FLAG_G);
+	dma_flag_clear(DMA0, DMA_CH4, DMA_FLAG_G);
+}
+
+
+/* Receive a block by DMA */
+static
+int rcvr_spi_dma (	/* 1:OK, 0:DMA stalled */
+	BYTE *buff,		/* Pointer to data buffer */
+	UINT btr		/* Number of bytes to receive */
+)
+{
+	uint64_t start;
+	int done;
+
+	dma_rx_start(buff, btr);
+	start = get_timer_value();
+	while (!(done = dma_flag_get(DMA0, DMA_CH3, DMA_FLAG_FTF))
+		&& get_timer_value() - start < (uint64_t)SystemCoreClock / 4000 * SD_DMA_TIMEOUT) ;
+	dma_rx_stop();
+
+	return done;
+}
+#endif
+
+
 /* Receive multiple byte */
 static
-void rcvr_spi_multi (
+int rcvr_spi_multi (	/* 1:OK, 0:Error */
 	BYTE *buff,		/* Pointer to data buffer */
-	UINT btr		/* Number of bytes to receive (even number) */
+	UINT btr		/* Number of bytes to receive */
 )
 {
-	do
-	{
-		*buff = xchg_spi(0xff);
-		buff++;
-	} while (btr--);
+#if SD_USE_DMA
+	if (DmaOn && btr >= SD_DMA_MIN) {
+		if (rcvr_spi_dma(buff, btr)) return 1;
+		DmaOn = 0;	/* This block is lost, later ones are polled */
+		return 0;
+	}
+#endif
+	while (btr--) {
+		*buff++ = xchg_spi(0xFF);
+	}
+	return 1;
+}
+
+
+/* Add a byte to the data block CRC */
+static
+WORD crc16_byte (
+	WORD crc,		/* CRC so far, 0 at the start of a block */
+	BYTE dat		/* Next data byte */
+)
+{
+	crc = (crc << 4) ^ Crc16Tbl[((crc >> 12) ^ (dat >> 4)) & 0x0F];
+	crc = (crc << 4) ^ Crc16Tbl[((crc >> 12) ^ dat) & 0x0F];
+	return crc;
+}
+
 
+/* Set the SPI clock and record it for disk_stats() */
+static
+void set_clock (
+	BYTE psc		/* Prescaler, SCLK = PCLK1 / (2 << psc) */
+)
+{
+	ClockPsc = psc;
+	FCLK_SET(psc);
+	Stats.clock_div = 2 << psc;
+	Stats.clock_hz = rcu_clock_freq_get(CK_APB1) >> (psc + 1);
 }
 
 
@@ -173,6 +377,26 @@ int _select (void)	/* 1:OK, 0:Timeout */
 /* Receive a data packet from the MMC                                    */
 /*-----------------------------------------------------------------------*/
 
+/* Check a received sector against its CRC16 (SD_VERIFY_CRC) */
+static
+int sector_crc_ok (	/* 1:OK or not checked, 0:Mismatch */
+	const BYTE *buff,	/* 512 bytes of data */
+	WORD rcrc			/* CRC16 sent by the card */
+)
+{
+	WORD crc;
+	UINT n;
+
+	if (!SD_VERIFY_CRC) return 1;
+	for (crc = 0, n = 0; n < 512; n++) crc = crc16_byte(crc, buff[n]);
+	if (crc != rcrc) {
+		Stats.crc_errors++;
+		return 0;
+	}
+	return 1;
+}
+
+
 static
 int rcvr_datablock (	/* 1:OK, 0:Error */
 	BYTE *buff,			/* Data buffer */
@@ -180,46 +404,84 @@ int rcvr_datablock (	/* 1:OK, 0:Error */
 )
 {
 	BYTE token;
+	WORD rcrc;
 
 	delay_timer1 = 200;
 	do {							/* Wait for DataStart token in timeout of 200ms */
 		token = xchg_spi(0xFF);
 		/* This loop will take a time. Insert rot_rdq() here for multitask envilonment. */
 	} while ((token == 0xFF) && delay_timer1);
-	if(token != 0xFE) return 0;		/* Function fails if invalid DataStart token or timeout */
+	if(token != 0xFE) {				/* Function fails if invalid DataStart token or timeout */
+		Stats.timeouts++;
+		return 0;
+	}
 
-	rcvr_spi_multi(buff, btr);		/* Store trailing data to the buffer */
-	xchg_spi(0xFF); xchg_spi(0xFF);			/* Discard CRC */
+	if (!rcvr_spi_multi(buff, btr)) return 0;	/* Store trailing data to the buffer */
+	rcrc = xchg_spi(0xFF) << 8;			/* CRC16 of the block */
+	rcrc |= xchg_spi(0xFF);
+
+	/* Only whole sectors are checked, ACMD13 reads a partial block */
+	if (btr == 512 && !sector_crc_ok(buff, rcrc)) return 0;
 
 	return 1;						/* Function succeeded */
 }
 
 
+#if FF_FS_READONLY == 0
+/* Send multiple byte */
+static
+void xmit_spi_multi (
+	const BYTE *buff,	/* Pointer to the data */
+	UINT btx			/* Number of bytes to send */
+)
+{
+	while (btx--) {
+		xchg_spi(*buff++);
+	}
+}
+
+
+static
+int xmit_datablock (	/* 1:OK, 0:Error */
+	const BYTE *buff,	/* 512 byte data block to be transmitted */
+	BYTE token			/* Data/Stop token */
+)
+{
+	BYTE resp;
+
+
+	if (!wait_ready(500)) return 0;		/* Wait for card ready */
+
+	xchg_spi(token);					/* Send token */
+	if (token != 0xFD) {				/* Send data if token is other than StopTran */
+		xmit_spi_multi(buff, 512);		/* Data */
+		xchg_spi(0xFF); xchg_spi(0xFF);	/* Dummy CRC */
+
+		resp = xchg_spi(0xFF);			/* Receive data resp */
+		if ((resp & 0x1F) != 0x05) {	/* Function fails if the data packet was not accepted */
+			Stats.rejects++;
+			return 0;
+		}
+	}
+	return 1;
+}
+#endif
+
+
 /*-----------------------------------------------------------------------*/
 /* Send a command packet to the MMC                                      */
 /*-----------------------------------------------------------------------*/
 
+/* Send a command packet to a selected, ready card */
 static
-BYTE send_cmd (		/* Return value: R1 resp (bit7==1:Failed to send) */
-	BYTE cmd,		/* Command index */
+BYTE xmit_cmd (		/* Return value: R1 resp (bit7==1:Failed to send) */
+	BYTE cmd,		/* Command index, not an ACMD */
 	DWORD arg		/* Argument */
 )
 {
 	BYTE n, res;
 
 
-	if (cmd & 0x80) {	/* Send a CMD55 prior to ACMD<n> */
-		cmd &= 0x7F;
-		res = send_cmd(CMD55, 0);
-		if (res > 1) return res;
-	}
-
-	/* Select the card and wait for ready except to stop multiple block read */
-	if (cmd != CMD12) {
-		deselect();
-		if (!_select()) return 0xFF;
-	}
-
 	/* Send command packet */
 	xchg_spi(0x40 | cmd);				/* Start + command index */
 	xchg_spi((BYTE)(arg >> 24));		/* Argument[31..24] */
@@ -241,66 +503,332 @@ BYTE send_cmd (		/* Return value: R1 resp (bit7==1:Failed to send) */
 	return res;							/* Return received response */
 }
 
+
+static
+BYTE send_cmd (		/* Return value: R1 resp (bit7==1:Failed to send) */
+	BYTE cmd,		/* Command index */
+	DWORD arg		/* Argument */
+)
+{
+	BYTE res;
+
+
+	if (cmd & 0x80) {	/* Send a CMD55 prior to ACMD<n> */
+		cmd &= 0x7F;
+		res = send_cmd(CMD55, 0);
+		if (res > 1) return res;
+	}
+
+	/* Select the card and wait for ready except to stop multiple block read */
+	if (cmd != CMD12) {
+		deselect();
+		if (!_select()) return 0xFF;
+	}
+
+	return xmit_cmd(cmd, arg);
+}
+
+/* Read sector 0 without storing it, for clock negotiation */
+static
+int probe_sector (	/* 1:OK, 0:Error */
+	WORD *crc		/* CRC16 of the sector */
+)
+{
+	BYTE token;
+	WORD c = 0, rcrc;
+	UINT n;
+	int ok = 0;
+
+	if (send_cmd(CMD17, 0) == 0) {
+		delay_timer1 = 200;
+		do {
+			token = xchg_spi(0xFF);
+		} while ((token == 0xFF) && delay_timer1);
+		if (token == 0xFE) {
+			for (n = 0; n < 512; n++) c = crc16_byte(c, xchg_spi(0xFF));
+			rcrc = xchg_spi(0xFF) << 8;
+			rcrc |= xchg_spi(0xFF);
+			ok = (rcrc == c);
+			if (!ok) Stats.crc_errors++;
+		} else {
+			Stats.timeouts++;
+		}
+	}
+	deselect();
+	*crc = c;
+	return ok;
+}
+
+
+/* Step the clock up while sector 0 keeps reading back intact */
+static
+void negotiate_clock (void)
+{
+	WORD ref, crc;
+	BYTE psc, n;
+
+	if (!probe_sector(&ref)) return;	/* Not even the slow clock works, leave it */
+
+	for (psc = PSC_SLOW - 1; ; psc--) {
+		set_clock(psc);
+		for (n = 0; n < SD_PROBE_READS; n++) {
+			if (!probe_sector(&crc) || crc != ref) break;
+		}
+		if (n < SD_PROBE_READS) {		/* This step is unreliable, keep the last good one */
+			set_clock(psc + 1);
+			break;
+		}
+		if (psc == 0) break;			/* PCLK1/2 is the fastest SPI clock */
+	}
+}
+
+
+#if SD_STREAM
+/* Close an open CMD18, the ring keeps what it holds */
+static
+void stream_stop (void)
+{
+	if (StreamNext == STREAM_IDLE) return;
+	send_cmd(CMD12, 0);			/* STOP_TRANSMISSION */
+	deselect();
+	StreamNext = STREAM_IDLE;
+}
+
+
+/* LBA the sequential reader takes next, STREAM_IDLE if it has none */
+static
+DWORD stream_pos (void)
+{
+	if (RingCount) return RingSector;
+	return StreamNext != STREAM_IDLE ? StreamNext : StreamResume;
+}
+
+
+/* A single sector away from the stream, e.g. a FAT or directory lookup.
+   One right after the previous side read means the file has moved on to
+   another fragment, that one restarts the stream instead. */
+static
+int is_side_read (
+	DWORD sector,	/* Start sector number (LBA) */
+	UINT count		/* Number of sectors */
+)
+{
+	DWORD pos = stream_pos();
+
+	if (count != 1 || pos == STREAM_IDLE || sector == SideNext) return 0;
+	return sector < pos || sector - pos > STREAM_GAP;
+}
+
+
+/* Read a side sector with CMD17. SPI cannot interleave it with an open
+   CMD18, so that is stopped and its position kept for disk_stream_pump()
+   or the next sequential read to reopen; the ring is left as it is. */
 static
-void init_timer2(void)
+UINT side_block (	/* Return value: sectors not read */
+	BYTE *buff,		/* Pointer to the data buffer */
+	DWORD sector	/* Sector number (LBA) */
+)
 {
-    timer_parameter_struct timer_initpara;
+	UINT count = 1;
+
+	if (StreamNext != STREAM_IDLE) {
+		StreamResume = StreamNext;
+		stream_stop();
+	}
+	SideNext = sector + 1;
+	if (!(CardType & CT_BLOCK)) sector *= 512;
+	if ((send_cmd(CMD17, sector) == 0) && rcvr_datablock(buff, 512)) count = 0;
+	deselect();
+	Stats.side_reads++;
 
-    rcu_periph_clock_enable(RCU_TIMER2);
-    timer_deinit(TIMER2);
-    /* ((1+TIM_Prescaler )/时钟)*(1+TIM_Period ) 
-        (108000/108000000)*(1000)=1ms
-    */
-    timer_initpara.period = (1000 - 1);
-    timer_initpara.prescaler         = (108 - 1);
-    timer_initpara.alignedmode       = TIMER_COUNTER_EDGE;
-    timer_initpara.counterdirection  = TIMER_COUNTER_UP;
-    timer_initpara.clockdivision     = TIMER_CKDIV_DIV1;
-    timer_initpara.repetitioncounter = 0;
-    timer_init(TIMER2, &timer_initpara);
+	return count;
+}
 
-    timer_update_event_enable(TIMER2);
-    timer_interrupt_enable(TIMER2,TIMER_INT_UP);
-    timer_flag_clear(TIMER2, TIMER_FLAG_UP);
-    timer_update_source_config(TIMER2, TIMER_UPDATE_SRC_GLOBAL);
 
-    /* TIMER2 counter enable */
-    timer_enable(TIMER2);
+/* Receive sectors from the open stream, opening one at sector if needed */
+static
+UINT stream_blocks (	/* Return value: sectors not read */
+	BYTE *buff,		/* Pointer to the data buffer */
+	DWORD sector,	/* Start sector number (LBA) */
+	UINT count		/* Number of sectors */
+)
+{
+	StreamResume = SideNext = STREAM_IDLE;	/* Back in sequence from here */
+	/* A sector or two served from the cache above leaves a gap, which is
+	   cheaper to read through than a CMD12 and a new CMD18 */
+	while (sector > StreamNext && sector - StreamNext <= STREAM_GAP) {
+		if (!rcvr_datablock(buff, 512)) {
+			stream_stop();
+			break;
+		}
+		StreamNext++;
+	}
+	if (StreamNext != sector) {		/* Out of sequence, restart the transfer */
+		stream_stop();
+		if (send_cmd(CMD18, (CardType & CT_BLOCK) ? sector : sector * 512) != 0) {
+			deselect();
+			return count;
+		}
+		StreamNext = sector;
+		Stats.streams++;
+	}
+	do {
+		if (!rcvr_datablock(buff, 512)) {
+			stream_stop();
+			break;
+		}
+		buff += 512;
+		StreamNext++;
+	} while (--count);
+
+	return count;
 }
+#endif
 
-/*!
-    \brief      time base IRQ
-    \param[in]  none
-    \param[out] none
-    \retval     none
-*/
+#if SD_ASYNC
+/* Complete the head request and start on the next one */
 static
-void tfcard_timer_irq (void)
+void async_finish (
+	BYTE state		/* SDREQ_DONE or SDREQ_ERROR */
+)
 {
-    if (RESET != timer_flag_get(TIMER2, TIMER_FLAG_UP)){
-        timer_flag_clear(TIMER2, TIMER_FLAG_UP);
+	SDREQ *req = AsyncHead;
 
-        if (delay_timer1 > 0x00U){
-            delay_timer1--;
-        }
-        if (delay_timer2 > 0x00U){
-            delay_timer2--;
-        }
-        // else {
-        //     timer_disable(TIMER2);
-        // }
-    }
+	if (AsyncState >= AS_TOKEN && req->count > 1) send_cmd(CMD12, 0);	/* STOP_TRANSMISSION */
+	deselect();
+	AsyncState = AS_IDLE;
+	AsyncHead = req->next;
+	if (!AsyncHead) AsyncTail = 0;
+	req->next = 0;
+	req->state = state;
+	if (req->done) req->done(req);	/* May queue the next request */
 }
 
-/*!
-    \brief      this function handles Timer0 updata interrupt request.
-    \param[in]  none
-    \param[out] none
-    \retval     none
-*/
-void TIMER2_IRQHandler(void)
+
+/* Fail the head request, stepping the clock down like mmc_disk_read */
+static
+void async_fail (void)
 {
-    // tfcard_timer_irq();
+	async_finish(SDREQ_ERROR);
+	if (++ErrRun >= SD_ERR_STEPDOWN && ClockPsc < PSC_SLOW) {	/* Marginal link, slow down */
+		set_clock(ClockPsc + 1);
+		Stats.stepdowns++;
+		ErrRun = 0;
+	}
+}
+
+
+/* One step of the request at the head of the queue */
+static
+void async_step (void)
+{
+	SDREQ *req = AsyncHead;
+	BYTE d;
+	DWORD addr;
+	WORD rcrc;
+
+	switch (AsyncState) {
+	case AS_IDLE :
+#if SD_STREAM
+		stream_stop();		/* The bus is taken over, the ring stays valid */
+#endif
+		req->state = SDREQ_BUSY;
+		AsyncSector = 0;
+		deselect();
+		CS_LOW();
+		xchg_spi(0xFF);		/* Dummy clock (force DO enabled) */
+		AsyncDeadline = get_timer_value() + MS_TICKS(500);
+		AsyncState = AS_READY;
+		break;
+
+	case AS_READY :
+		if (xchg_spi(0xFF) != 0xFF) {		/* Still busy */
+			if (get_timer_value() > AsyncDeadline) async_fail();
+			break;
+		}
+		addr = (CardType & CT_BLOCK) ? req->sector : req->sector * 512;
+		if (xmit_cmd(req->count > 1 ? CMD18 : CMD17, addr) != 0) {
+			async_fail();
+			break;
+		}
+		AsyncDeadline = get_timer_value() + MS_TICKS(200);
+		AsyncState = AS_TOKEN;
+		break;
+
+	case AS_TOKEN :
+		d = xchg_spi(0xFF);
+		if (d == 0xFF) {
+			if (get_timer_value() > AsyncDeadline) {
+				Stats.timeouts++;
+				async_fail();
+			}
+			break;
+		}
+		if (d != 0xFE) {
+			Stats.timeouts++;
+			async_fail();
+			break;
+		}
+		AsyncByte = 0;
+		AsyncDeadline = get_timer_value() + MS_TICKS(SD_DMA_TIMEOUT);
+#if SD_USE_DMA
+		if (DmaOn) dma_rx_start(req->buff + AsyncSector * 512, 512);
+#endif
+		AsyncState = AS_DATA;
+		break;
+
+	case AS_DATA :
+#if SD_USE_DMA
+		if (DmaOn) {
+			if (!dma_flag_get(DMA0, DMA_CH3, DMA_FLAG_FTF)) {
+				if (get_timer_value() > AsyncDeadline) {
+					dma_rx_stop();
+					DmaOn = 0;	/* Later blocks are polled */
+					async_fail();
+				}
+				break;
+			}
+			dma_rx_stop();
+			AsyncByte = 512;
+		}
+#endif
+		for (d = 0; d < AS_POLL_BYTES && AsyncByte < 512; d++) {
+			req->buff[AsyncSector * 512 + AsyncByte++] = xchg_spi(0xFF);
+		}
+		if (AsyncByte < 512) break;
+		rcrc = xchg_spi(0xFF) << 8;			/* CRC16 of the block */
+		rcrc |= xchg_spi(0xFF);
+		if (!sector_crc_ok(req->buff + AsyncSector * 512, rcrc)) {
+			async_fail();
+			break;
+		}
+		if (++AsyncSector == req->count) {
+			ErrRun = 0;
+			async_finish(SDREQ_DONE);
+			break;
+		}
+		AsyncDeadline = get_timer_value() + MS_TICKS(200);
+		AsyncState = AS_TOKEN;
+		break;
+	}
+}
+
+
+/* Run the queue to the end, before the bus is used synchronously */
+static
+void async_drain (void)
+{
+	while (AsyncHead) async_step();
+}
+#endif
+
+
+/* 1kHz decrement of the wait timers, registered with Tick_Register() */
+static
+void disk_timerproc (void)
+{
+	if (delay_timer1) delay_timer1--;
+	if (delay_timer2) delay_timer2--;
 }
 
 
@@ -323,9 +851,21 @@ DSTATUS disk_initialize (
 
 
 	if (drv) return STA_NOINIT;			/* Supports only drive 0 */
+#if SD_ASYNC
+	while (AsyncHead) {					/* Fail whatever is queued, the card is reset */
+		AsyncState = AS_IDLE;
+		async_finish(SDREQ_ERROR);
+	}
+#endif
+#if SD_STREAM
+	Streaming = 0;
+	StreamNext = STREAM_IDLE;			/* Whatever was open is lost with the reset */
+	StreamResume = SideNext = STREAM_IDLE;
+	RingCount = 0;
+#endif
+	Tick_Register(disk_timerproc);		/* Drives the wait timeouts */
 	init_spi();							/* Initialize SPI */
-    delay_1ms(10);
-    init_timer2();
+	delay_1ms(10);
 
 	if (Stat & STA_NODISK) return Stat;	/* Is card existing in the soket? */
 
@@ -360,7 +900,10 @@ DSTATUS disk_initialize (
 	deselect();
 
 	if (ty) {			/* OK */
-		FCLK_FAST();			/* Set fast clock */
+		set_clock(PSC_SLOW);
+		negotiate_clock();		/* Set the fastest clock that reads back intact */
+		ErrRun = 0;
+		disk_cache_invalidate();	/* The card may have been swapped */
 		Stat &= ~STA_NOINIT;	/* Clear STA_NOINIT flag */
 	} else {			/* Failed */
 		Stat = STA_NOINIT;
@@ -390,16 +933,20 @@ DSTATUS disk_status (
 /* Read sector(s)                                                        */
 /*-----------------------------------------------------------------------*/
 
-DRESULT disk_read (
-	BYTE drv,		/* Physical drive number (0) */
+/* One attempt at reading sectors */
+static
+UINT read_blocks (	/* Return value: sectors not read */
 	BYTE *buff,		/* Pointer to the data buffer to store read data */
 	DWORD sector,	/* Start sector number (LBA) */
 	UINT count		/* Number of sectors to read (1..128) */
 )
 {
-	if (drv || !count) return RES_PARERR;		/* Check parameter */
-	if (Stat & STA_NOINIT) return RES_NOTRDY;	/* Check if drive is ready */
-
+#if SD_STREAM
+	if (Streaming) {
+		if (is_side_read(sector, count)) return side_block(buff, sector);
+		return stream_blocks(buff, sector, count);
+	}
+#endif
 	if (!(CardType & CT_BLOCK)) sector *= 512;	/* LBA ot BA conversion (byte addressing cards) */
 
 	if (count == 1) {	/* Single sector read */
@@ -419,17 +966,236 @@ DRESULT disk_read (
 	}
 	deselect();
 
-	return count ? RES_ERROR : RES_OK;	/* Return result */
+	return count;
+}
+
+
+/* Card read under the sector cache, see diskcache.c */
+DRESULT mmc_disk_read (
+	BYTE drv,		/* Physical drive number (0) */
+	BYTE *buff,		/* Pointer to the data buffer to store read data */
+	DWORD sector,	/* Start sector number (LBA) */
+	UINT count		/* Number of sectors to read (1..128) */
+)
+{
+	BYTE retry;
+
+	if (drv || !count) return RES_PARERR;		/* Check parameter */
+	if (Stat & STA_NOINIT) return RES_NOTRDY;	/* Check if drive is ready */
+#if SD_ASYNC
+	async_drain();
+#endif
+
+#if SD_STREAM
+	if (RingCount && RingSector != sector && !(Streaming && is_side_read(sector, count))) {
+		RingCount = 0;		/* Prefetch missed, drop it */
+	}
+	while (RingCount && count) {	/* Copy out prefetched sectors */
+		memcpy(buff, Ring + RingHead * 512, 512);
+		if (++RingHead == RingSize) RingHead = 0;
+		RingCount--;
+		RingSector++;
+		Stats.ring_hits++;
+		buff += 512;
+		sector++;
+		count--;
+	}
+	if (!count) return RES_OK;
+#endif
+
+	for (retry = 0; retry <= SD_READ_RETRIES; retry++) {
+		if (retry) Stats.retries++;
+		if (!read_blocks(buff, sector, count)) {
+			ErrRun = 0;
+			return RES_OK;
+		}
+		if (++ErrRun >= SD_ERR_STEPDOWN && ClockPsc < PSC_SLOW) {	/* Marginal link, slow down */
+			set_clock(ClockPsc + 1);
+			Stats.stepdowns++;
+			ErrRun = 0;
+		}
+	}
+
+	return RES_ERROR;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Clock and error counters                                              */
+/*-----------------------------------------------------------------------*/
+
+const SDSTATS* disk_stats (void)
+{
+	return &Stats;
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Sequential streaming                                                  */
+/*-----------------------------------------------------------------------*/
+
+#if SD_STREAM
+void disk_stream_begin (
+	BYTE *ring,		/* Prefetch buffer of sectors * 512 bytes, NULL for none */
+	UINT sectors	/* Ring size in sectors */
+)
+{
+	Streaming = 1;
+	StreamResume = SideNext = STREAM_IDLE;
+	Ring = ring;
+	RingSize = ring ? sectors : 0;
+	RingHead = RingCount = 0;
+}
+
+
+void disk_stream_end (void)
+{
+	stream_stop();
+	Streaming = 0;
+	StreamResume = SideNext = STREAM_IDLE;
+	Ring = 0;
+	RingSize = RingCount = 0;
 }
 
 
+UINT disk_stream_pump (	/* Return value: sectors received */
+	UINT n			/* Most sectors to receive in this call */
+)
+{
+	UINT done = 0, slot;
+
+	if (!RingSize) return 0;
+	if (StreamNext == STREAM_IDLE) {	/* Reopen what a side read stopped */
+		if (StreamResume == STREAM_IDLE || RingCount == RingSize) return 0;	/* Nothing to follow */
+		if (send_cmd(CMD18, (CardType & CT_BLOCK) ? StreamResume : StreamResume * 512) != 0) {
+			deselect();
+			StreamResume = STREAM_IDLE;
+			return 0;
+		}
+		StreamNext = StreamResume;
+		StreamResume = STREAM_IDLE;
+		Stats.streams++;
+	}
+	if (!RingCount) {
+		RingHead = 0;
+		RingSector = StreamNext;
+	}
+	while (done < n && RingCount < RingSize) {
+		slot = RingHead + RingCount;
+		if (slot >= RingSize) slot -= RingSize;
+		if (!rcvr_datablock(Ring + slot * 512, 512)) {	/* Maybe past the card end, not an error yet */
+			stream_stop();
+			break;
+		}
+		StreamNext++;
+		RingCount++;
+		Stats.prefetched++;
+		done++;
+	}
+
+	return done;
+}
+#endif
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Sequential read benchmark                                             */
+/*-----------------------------------------------------------------------*/
+
+DWORD disk_bench (	/* Return value: throughput [KB/s], 0 on error */
+	BYTE drv,		/* Physical drive number (0) */
+	BYTE *buff,		/* Work buffer of chunk * 512 bytes */
+	DWORD sector,	/* Start sector number (LBA) */
+	UINT count,		/* Number of sectors to read in total */
+	UINT chunk,		/* Sectors per read call, >1 streams with CMD18 */
+	BYTE dma		/* 0: poll every byte, 1: use DMA if available */
+)
+{
+	uint64_t start, ticks;
+	UINT done;
+#if SD_USE_DMA
+	BYTE dma_was = DmaOn;
+
+	DmaOn = dma;
+#else
+	(void)dma;
+#endif
+	start = get_timer_value();
+	for (done = 0; done < count; done += chunk) {
+		if (chunk > count - done) chunk = count - done;
+		if (mmc_disk_read(drv, buff, sector + done, chunk) != RES_OK) break;	/* Raw card speed, bypass the cache */
+	}
+	ticks = get_timer_value() - start;
+#if SD_USE_DMA
+	DmaOn = dma_was && DmaOn == dma;	/* Keep a stall seen during the run */
+#endif
+
+	if (done < count || !ticks) return 0;
+	/* bytes / (ticks / (SystemCoreClock / 4)) / 1024 */
+	return (DWORD)((uint64_t)count * 512 * (SystemCoreClock / 4) / 1024 / ticks);
+}
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Asynchronous reads                                                    */
+/*-----------------------------------------------------------------------*/
+
+#if SD_ASYNC
+DRESULT disk_async_read (
+	SDREQ *req		/* buff, sector, count, done and user filled in by the caller */
+)
+{
+	if (!req->count || !req->buff) return RES_PARERR;	/* Check parameter */
+	if (req->state == SDREQ_QUEUED || req->state == SDREQ_BUSY) return RES_PARERR;	/* Already in the queue */
+	if (Stat & STA_NOINIT) return RES_NOTRDY;	/* Check if drive is ready */
+
+	req->state = SDREQ_QUEUED;
+	req->next = 0;
+	if (AsyncTail) {
+		AsyncTail->next = req;
+	} else {
+		AsyncHead = req;
+	}
+	AsyncTail = req;
+
+	return RES_OK;
+}
+
+
+UINT disk_async_poll (	/* Return value: requests still queued */
+	UINT us			/* Time to spend, returns early when the queue empties */
+)
+{
+	uint64_t end = get_timer_value() + (uint64_t)SystemCoreClock / 4000000 * us;
+
+	while (AsyncHead && get_timer_value() < end) async_step();
+
+	return disk_async_pending();
+}
+
+
+UINT disk_async_pending (void)	/* Return value: requests queued or in flight */
+{
+	UINT n;
+	SDREQ *req;
+
+	for (n = 0, req = AsyncHead; req; req = req->next) n++;
+	return n;
+}
+#endif
+
+
 
 /*-----------------------------------------------------------------------*/
 /* Write sector(s)                                                       */
 /*-----------------------------------------------------------------------*/
 
 #if FF_FS_READONLY == 0
-DRESULT disk_write (
+DRESULT mmc_disk_write (	/* Card write under the sector cache */
 	BYTE drv,			/* Physical drive number (0) */
 	const BYTE *buff,	/* Ponter to the data to write */
 	DWORD sector,		/* Start sector number (LBA) */
@@ -439,6 +1205,13 @@ DRESULT disk_write (
 	if (drv || !count) return RES_PARERR;		/* Check parameter */
 	if (Stat & STA_NOINIT) return RES_NOTRDY;	/* Check drive status */
 	if (Stat & STA_PROTECT) return RES_WRPRT;	/* Check write protect */
+#if SD_ASYNC
+	async_drain();
+#endif
+#if SD_STREAM
+	stream_stop();
+	RingCount = 0;	/* May hold the sectors being written */
+#endif
 
 	if (!(CardType & CT_BLOCK)) sector *= 512;	/* LBA ==> BA conversion (byte addressing cards) */
 
@@ -482,6 +1255,12 @@ DRESULT disk_ioctl (
 
 	if (drv) return RES_PARERR;					/* Check parameter */
 	if (Stat & STA_NOINIT) return RES_NOTRDY;	/* Check if drive is ready */
+#if SD_ASYNC
+	async_drain();
+#endif
+#if SD_STREAM
+	stream_stop();
+#endif
 
 	res = RES_ERROR;
 
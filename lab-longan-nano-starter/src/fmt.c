@@ -0,0 +1,67 @@
+#include "fmt.h"
+
+char *Fmt_Str(char *out, const char *s) {
+  while (*s)
+    *out++ = *s++;
+  *out = '\0';
+  return out;
+}
+
+/**
+ * @param[in] width minimum digits, filled on the left with pad
+ * @returns the terminating NUL
+ * */
+char *Fmt_Udec(char *out, uint32_t v, int width, char pad) {
+  char digits[10];
+  int n = 0;
+
+  // Division by a constant 10 compiles to a multiply and shift
+  do {
+    digits[n++] = '0' + v % 10;
+    v /= 10;
+  } while (v);
+  while (width-- > n)
+    *out++ = pad;
+  while (n)
+    *out++ = digits[--n];
+  *out = '\0';
+  return out;
+}
+
+/**
+ * Negative numbers get a leading '-'; with '0' padding it goes before the
+ * zeros, otherwise right before the digits.
+ * */
+char *Fmt_Sdec(char *out, int32_t v, int width, char pad) {
+  uint32_t mag = v < 0 ? 0u - (uint32_t)v : (uint32_t)v;
+
+  if (v >= 0)
+    return Fmt_Udec(out, mag, width, pad);
+  if (pad == '0') {
+    *out++ = '-';
+    return Fmt_Udec(out, mag, width - 1, pad);
+  }
+
+  char digits[11];
+  int n = Fmt_Udec(digits, mag, 1, pad) - digits;
+  while (width-- > n + 1)
+    *out++ = pad;
+  *out++ = '-';
+  return Fmt_Str(out, digits);
+}
+
+/**
+ * @param[in] width minimum digits, zero-filled, no 0x prefix
+ * */
+char *Fmt_Hex(char *out, uint32_t v, int width) {
+  int n = 1;
+
+  while (n < 8 && (v >> (4 * n)))
+    ++n;
+  if (width > n)
+    n = width;
+  for (int i = n - 1; i >= 0; --i)
+    *out++ = i < 8 ? "0123456789abcdef"[(v >> (4 * i)) & 0xF] : '0';
+  *out = '\0';
+  return out;
+}
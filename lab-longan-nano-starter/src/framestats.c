@@ -0,0 +1,84 @@
+#include "framestats.h"
+#include "gd32vf103_libopt.h"
+
+#define RING_MASK (FSTAT_RING - 1)
+#define LOW1_N (FSTAT_RING / 100 + 1) // worst frames that make up the 1%
+
+// Low 32 bits of mtime are enough, frame deltas never get near a wrap
+static uint32_t stamps[FSTAT_RING];
+static uint16_t entities[FSTAT_RING];
+static uint32_t head;   // index of the next slot to write
+static uint32_t filled; // valid entries, saturates at FSTAT_RING
+static uint32_t window_start;
+static uint32_t window_len;
+static FrameStats published;
+
+static void publish(uint32_t now) {
+  uint32_t hz = SystemCoreClock / 4;
+  uint32_t span = now - window_start;
+  uint32_t min_delta = UINT32_MAX, max_delta = 0, entity_sum = 0;
+  uint32_t worst[LOW1_N] = {0};
+  uint32_t n = 0;
+
+  for (uint32_t i = 1; i < filled; ++i) {
+    uint32_t cur = (head - i) & RING_MASK;
+    uint32_t delta = stamps[cur] - stamps[(cur - 1) & RING_MASK];
+
+    // Keep the LOW1_N largest deltas sorted, largest first
+    for (int k = 0; k < LOW1_N; ++k) {
+      if (delta > worst[k]) {
+        for (int j = LOW1_N - 1; j > k; --j)
+          worst[j] = worst[j - 1];
+        worst[k] = delta;
+        break;
+      }
+    }
+
+    if (now - stamps[cur] >= span)
+      continue;
+    n++;
+    entity_sum += entities[cur];
+    if (delta < min_delta)
+      min_delta = delta;
+    if (delta > max_delta)
+      max_delta = delta;
+  }
+
+  if (n == 0)
+    return;
+  published.frames = n;
+  published.fps_avg = (uint64_t)n * hz / span;
+  published.fps_min = hz / max_delta;
+  published.fps_max = hz / min_delta;
+  published.fps_low1 = worst[LOW1_N - 1] ? hz / worst[LOW1_N - 1]
+                                         : published.fps_min;
+  published.entities = entity_sum / n;
+}
+
+/**
+ * Record a finished frame. Never blocks; the published figures are
+ * refreshed once every FSTAT_WINDOW_MS.
+ * @param[in] entity_count entities on screen in this frame
+ * */
+void Fstat_Push(uint32_t entity_count) {
+  uint32_t now = (uint32_t)get_timer_value();
+
+  stamps[head] = now;
+  entities[head] = entity_count;
+  head = (head + 1) & RING_MASK;
+  if (filled < FSTAT_RING)
+    filled++;
+
+  if (window_len == 0) {
+    window_len = SystemCoreClock / 4 / 1000 * FSTAT_WINDOW_MS;
+    window_start = now;
+  } else if (now - window_start >= window_len) {
+    publish(now);
+    window_start = now;
+  }
+}
+
+/**
+ * @returns the figures of the last completed window
+ * */
+const FrameStats *Fstat_Get(void) { return &published; }
@@ -0,0 +1,95 @@
+#include "frametime.h"
+#include "gd32vf103_libopt.h"
+#include "scheduler.h"
+#include "serial.h"
+
+static FrameTimeHist hist;
+
+static int bin_of(uint32_t us) {
+  int msb, bin;
+  if (us < 2)
+    return us;
+  msb = 31 - __builtin_clz(us);
+  bin = msb * 2 + ((us >> (msb - 1)) & 1);
+  return bin < FTIME_BINS ? bin : FTIME_BINS - 1;
+}
+
+// Smallest frame time in microseconds that lands in bin
+static uint32_t bin_floor(int bin) {
+  if (bin < 2)
+    return bin;
+  return (2u | (bin & 1)) << (bin / 2 - 1);
+}
+
+/**
+ * Add the frame that Sched_FrameDone just closed. Call after
+ * Prof_FrameEnd so the worst frame can be attributed to phases.
+ * */
+void Ftime_Record(void) {
+  uint32_t us = Sched_Stats()->last_frame_time / (SystemCoreClock / 4000000);
+
+  hist.frames++;
+  hist.bins[bin_of(us)]++;
+  if (us > hist.worst_us) {
+    hist.worst_us = us;
+    hist.worst_frame = Sched_Stats()->frames;
+    for (int p = 0; p < PROF_PHASES; ++p)
+      hist.worst_cycles[p] = Prof_Cycles(p, 1);
+  }
+}
+
+void Ftime_Reset(void) {
+  hist.frames = hist.worst_us = hist.worst_frame = 0;
+  for (int i = 0; i < FTIME_BINS; ++i)
+    hist.bins[i] = 0;
+}
+
+/**
+ * @param[in] pct percentile, 1..100
+ * @returns upper edge in microseconds of the bin holding that percentile
+ * */
+uint32_t Ftime_Percentile(uint32_t pct) {
+  uint32_t need = (hist.frames * pct + 99) / 100;
+  uint32_t seen = 0;
+
+  for (int i = 0; i < FTIME_BINS - 1; ++i) {
+    seen += hist.bins[i];
+    if (seen >= need)
+      return bin_floor(i + 1);
+  }
+  return hist.worst_us;
+}
+
+const FrameTimeHist *Ftime_Get(void) { return &hist; }
+
+static void write_field(const char *name, uint32_t v) {
+  Serial_PutChar(' ');
+  Serial_Write(name);
+  Serial_PutChar('=');
+  Serial_WriteDec(v);
+}
+
+/**
+ * Write the histogram to USART0 between FTIME markers.
+ * */
+void Ftime_Dump(void) {
+  Serial_Write("FTIME BEGIN");
+  write_field("frames", hist.frames);
+  write_field("p50_us", Ftime_Percentile(50));
+  write_field("p99_us", Ftime_Percentile(99));
+  write_field("worst_us", hist.worst_us);
+  write_field("worst_frame", hist.worst_frame);
+  Serial_Write("\r\nworst");
+  for (int p = 0; p < PROF_PHASES; ++p)
+    write_field(Prof_Name(p), hist.worst_cycles[p]);
+  Serial_Write("\r\n");
+  for (int i = 0; i < FTIME_BINS; ++i) {
+    if (hist.bins[i] == 0)
+      continue;
+    Serial_WriteDec(bin_floor(i));
+    Serial_PutChar(' ');
+    Serial_WriteDec(hist.bins[i]);
+    Serial_Write("\r\n");
+  }
+  Serial_Write("FTIME END\r\n");
+}
@@ -0,0 +1,164 @@
+#include "input.h"
+#include "debounce.h"
+#include "riscv_encoding.h"
+#include "spsc.h"
+#include "tick.h"
+#include "utils.h"
+
+static DebounceKey keys[7];
+static volatile uint8_t held; // debounced level of every key, bit per key
+static uint32_t debounce_ticks;
+
+// Produced by the EXTI handlers, consumed by the game loop
+SPSC_DECLARE(events, InputEvent, INPUT_QUEUE_SIZE)
+static volatile uint32_t dropped;
+
+// Producer side. Input_Settle also pushes, from the tick interrupt at the
+// same ECLIC level as the EXTI handlers or with interrupts masked, so
+// there is never more than one producer running at a time.
+static void push(uint8_t key, uint8_t pressed, uint32_t stamp) {
+  InputEvent ev = {stamp, key, pressed};
+  if (!events_push(&ev))
+    dropped++;
+}
+
+static void report(uint8_t key, uint32_t stamp) {
+  if (keys[key].level)
+    held |= 1 << key;
+  else
+    held &= ~(1 << key);
+  push(key, keys[key].level, stamp);
+}
+
+static void on_edge(uint8_t key, uint32_t port, uint32_t pin) {
+  uint32_t now = (uint32_t)get_timer_value();
+  uint8_t raw = (GPIO_ISTAT(port) & pin) != 0;
+
+  if (Debounce_Edge(&keys[key], raw, now, debounce_ticks))
+    report(key, now);
+}
+
+void EXTI0_IRQHandler(void) {
+  exti_interrupt_flag_clear(EXTI_0);
+  on_edge(JOY_CTR, GPIOA, GPIO_PIN_0);
+}
+
+void EXTI1_IRQHandler(void) {
+  exti_interrupt_flag_clear(EXTI_1);
+  on_edge(JOY_LEFT, GPIOA, GPIO_PIN_1);
+}
+
+void EXTI2_IRQHandler(void) {
+  exti_interrupt_flag_clear(EXTI_2);
+  on_edge(JOY_DOWN, GPIOA, GPIO_PIN_2);
+}
+
+void EXTI3_IRQHandler(void) {
+  exti_interrupt_flag_clear(EXTI_3);
+  on_edge(JOY_RIGHT, GPIOA, GPIO_PIN_3);
+}
+
+void EXTI10_15_IRQHandler(void) {
+  if (RESET != exti_interrupt_flag_get(EXTI_13)) {
+    exti_interrupt_flag_clear(EXTI_13);
+    on_edge(JOY_UP, GPIOC, GPIO_PIN_13);
+  }
+  if (RESET != exti_interrupt_flag_get(EXTI_14)) {
+    exti_interrupt_flag_clear(EXTI_14);
+    on_edge(BUTTON_2, GPIOC, GPIO_PIN_14);
+  }
+  if (RESET != exti_interrupt_flag_get(EXTI_15)) {
+    exti_interrupt_flag_clear(EXTI_15);
+    on_edge(BUTTON_1, GPIOC, GPIO_PIN_15);
+  }
+}
+
+/**
+ * Route PA0-3 and PC13-15 to EXTI on both edges. The pins themselves are
+ * configured by Inp_init.
+ * */
+void Input_Init(void) {
+  static const uint8_t sources[][2] = {
+      {GPIO_PORT_SOURCE_GPIOA, GPIO_PIN_SOURCE_0},
+      {GPIO_PORT_SOURCE_GPIOA, GPIO_PIN_SOURCE_1},
+      {GPIO_PORT_SOURCE_GPIOA, GPIO_PIN_SOURCE_2},
+      {GPIO_PORT_SOURCE_GPIOA, GPIO_PIN_SOURCE_3},
+      {GPIO_PORT_SOURCE_GPIOC, GPIO_PIN_SOURCE_13},
+      {GPIO_PORT_SOURCE_GPIOC, GPIO_PIN_SOURCE_14},
+      {GPIO_PORT_SOURCE_GPIOC, GPIO_PIN_SOURCE_15},
+  };
+  static const exti_line_enum lines[] = {EXTI_0,  EXTI_1,  EXTI_2, EXTI_3,
+                                         EXTI_13, EXTI_14, EXTI_15};
+
+  debounce_ticks = SystemCoreClock / 4 / 1000 * INPUT_DEBOUNCE_MS;
+  for (int i = 0; i < 7; ++i)
+    keys[i].level = Get_Button(i);
+
+  rcu_periph_clock_enable(RCU_AF);
+  for (int i = 0; i < 7; ++i) {
+    gpio_exti_source_select(sources[i][0], sources[i][1]);
+    exti_init(lines[i], EXTI_INTERRUPT, EXTI_TRIG_BOTH);
+    exti_interrupt_flag_clear(lines[i]);
+  }
+
+  eclic_irq_enable(EXTI0_IRQn, 2, 0);
+  eclic_irq_enable(EXTI1_IRQn, 2, 0);
+  eclic_irq_enable(EXTI2_IRQn, 2, 0);
+  eclic_irq_enable(EXTI3_IRQn, 2, 0);
+  eclic_irq_enable(EXTI10_15_IRQn, 2, 0);
+
+  // Locks end within a millisecond of INPUT_DEBOUNCE_MS, not a frame
+  Tick_Register(Input_Settle);
+  Tick_Init();
+}
+
+/**
+ * @param[out] ev next debounced event
+ * @returns 1 if an event was taken from the queue, 0 if it was empty
+ * */
+int Input_Poll(InputEvent *ev) { return events_pop(ev); }
+
+/**
+ * Drop queued events and resync every key with its pin, e.g. after a
+ * stretch of time in which Input_Settle was not being called.
+ * */
+void Input_Flush(void) {
+  InputEvent ev;
+  uint32_t mie = clear_csr(mstatus, MSTATUS_MIE) & MSTATUS_MIE;
+
+  held = 0;
+  for (int i = 0; i < 7; ++i) {
+    keys[i].state = DEBOUNCE_STABLE;
+    keys[i].level = keys[i].raw = Get_Button(i);
+    held |= keys[i].level << i;
+  }
+  while (Input_Poll(&ev))
+    ;
+  if (mie)
+    set_csr(mstatus, MSTATUS_MIE);
+}
+
+/**
+ * Report keys whose level changed while they were locked out. Runs from
+ * the 1 kHz tick; calling it from the game loop as well is harmless.
+ * */
+void Input_Settle(void) {
+  uint32_t now = (uint32_t)get_timer_value();
+
+  for (uint8_t i = 0; i < 7; ++i) {
+    if (keys[i].state != DEBOUNCE_LOCKED)
+      continue;
+    uint32_t mie = clear_csr(mstatus, MSTATUS_MIE) & MSTATUS_MIE;
+    if (Debounce_Settle(&keys[i], now, debounce_ticks))
+      report(i, now);
+    if (mie)
+      set_csr(mstatus, MSTATUS_MIE);
+  }
+}
+
+/**
+ * @returns debounced levels, bit n set while key n is held
+ * */
+uint8_t Input_Held(void) { return held; }
+
+uint32_t Input_Dropped(void) { return dropped; }
@@ -0,0 +1,94 @@
+#include "latency.h"
+#include "gd32vf103_libopt.h"
+#include "serial.h"
+
+static uint32_t window[LAT_WINDOW];
+static uint32_t pending_edge, pending_tick;
+static int pending;
+static LatStats stats;
+
+static uint32_t to_us(uint32_t mtime_ticks) {
+  return mtime_ticks / (SystemCoreClock / 4000000);
+}
+
+/**
+ * A logic tick consumed a movement press that was stamped at edge_stamp.
+ * Ignored while an earlier press is still waiting for its photon.
+ * */
+void Lat_Input(uint32_t edge_stamp) {
+  uint32_t now = (uint32_t)get_timer_value();
+
+  if (pending && to_us(now - pending_tick) < LAT_TIMEOUT_MS * 1000)
+    return;
+  pending_edge = edge_stamp;
+  pending_tick = now;
+  pending = 1;
+}
+
+/**
+ * The rectangle of the moved player has just been written over SPI.
+ * A press older than LAT_TIMEOUT_MS never drew and is dropped unrecorded.
+ * */
+void Lat_Photon(void) {
+  uint32_t now = (uint32_t)get_timer_value();
+  uint32_t sum = 0, max = 0, n;
+
+  if (!pending)
+    return;
+  pending = 0;
+  if (to_us(now - pending_tick) >= LAT_TIMEOUT_MS * 1000)
+    return;
+
+  stats.edge_tick_us = to_us(pending_tick - pending_edge);
+  stats.tick_photon_us = to_us(now - pending_tick);
+  stats.last_us = to_us(now - pending_edge);
+  window[stats.samples % LAT_WINDOW] = stats.last_us;
+  stats.samples++;
+
+  n = stats.samples < LAT_WINDOW ? stats.samples : LAT_WINDOW;
+  for (uint32_t i = 0; i < n; ++i) {
+    sum += window[i];
+    if (window[i] > max)
+      max = window[i];
+  }
+  stats.avg_us = sum / n;
+  stats.max_us = max;
+}
+
+const LatStats *Lat_Get(void) { return &stats; }
+
+/**
+ * Write the window as a log2 histogram to USART0 between LAT markers.
+ * */
+void Lat_Dump(void) {
+  uint32_t bins[LAT_BINS] = {0};
+  uint32_t n = stats.samples < LAT_WINDOW ? stats.samples : LAT_WINDOW;
+
+  for (uint32_t i = 0; i < n; ++i) {
+    int b = window[i] ? 31 - __builtin_clz(window[i]) : 0;
+    bins[b < LAT_BINS ? b : LAT_BINS - 1]++;
+  }
+
+  Serial_Write("LAT BEGIN samples=");
+  Serial_WriteDec(stats.samples);
+  Serial_Write(" last_us=");
+  Serial_WriteDec(stats.last_us);
+  Serial_Write(" edge_tick_us=");
+  Serial_WriteDec(stats.edge_tick_us);
+  Serial_Write(" tick_photon_us=");
+  Serial_WriteDec(stats.tick_photon_us);
+  Serial_Write(" avg_us=");
+  Serial_WriteDec(stats.avg_us);
+  Serial_Write(" max_us=");
+  Serial_WriteDec(stats.max_us);
+  Serial_Write("\r\n");
+  for (int b = 0; b < LAT_BINS; ++b) {
+    if (bins[b] == 0)
+      continue;
+    Serial_WriteDec(1u << b);
+    Serial_PutChar(' ');
+    Serial_WriteDec(bins[b]);
+    Serial_Write("\r\n");
+  }
+  Serial_Write("LAT END\r\n");
+}
@@ -1,6 +1,7 @@
 #include "lcd/lcd.h"
-#include "lcd/oledfont.h"
-#include "lcd/bmp.h"
+#include "lcd/assets.h"
+#include "fmt.h"
+#include "ramfunc.h"
 u16 BACK_COLOR;   //Background color
 
 
@@ -9,15 +10,16 @@ u16 BACK_COLOR;   //Background color
        Entry data: serial data to be written to dat
        Return value: None
 ******************************************************************************/
-void LCD_Writ_Bus(u8 dat) 
+RAMFUNC void LCD_Writ_Bus(u8 dat) 
 {
 #if SPI0_CFG == 1
 	OLED_CS_Clr();
 
-	while(RESET == spi_i2s_flag_get(SPI0, SPI_FLAG_TBE));
-        spi_i2s_data_transmit(SPI0, dat);
-	while(RESET == spi_i2s_flag_get(SPI0, SPI_FLAG_RBNE));
-        spi_i2s_data_receive(SPI0);
+	//Register access keeps this loop in RAM, see include/ramfunc.h
+	while(!(SPI_STAT(SPI0)&SPI_FLAG_TBE));
+        SPI_DATA(SPI0)=dat;
+	while(!(SPI_STAT(SPI0)&SPI_FLAG_RBNE));
+        (void)SPI_DATA(SPI0);
 
 	OLED_CS_Set();
 #elif SPI0_CFG == 2
@@ -45,7 +47,7 @@ void LCD_Writ_Bus(u8 dat)
        Entry data: data written by dat
        Return value: None
 ******************************************************************************/
-void LCD_WR_DATA8(u8 dat)
+RAMFUNC void LCD_WR_DATA8(u8 dat)
 {
 	OLED_DC_Set();//Write data
 	LCD_Writ_Bus(dat);
@@ -57,7 +59,7 @@ void LCD_WR_DATA8(u8 dat)
        Entry data: data written by dat
        Return value: None
 ******************************************************************************/
-void LCD_WR_DATA(u16 dat)
+RAMFUNC void LCD_WR_DATA(u16 dat)
 {
 	OLED_DC_Set();//Write data
 	LCD_Writ_Bus(dat>>8);
@@ -70,7 +72,7 @@ void LCD_WR_DATA(u16 dat)
        Entry data: command written by dat
        Return value: None
 ******************************************************************************/
-void LCD_WR_REG(u8 dat)
+RAMFUNC void LCD_WR_REG(u8 dat)
 {
 	OLED_DC_Clr();//Write command
 	LCD_Writ_Bus(dat);
@@ -83,7 +85,7 @@ void LCD_WR_REG(u8 dat)
                    y1, y2 set the start and end addresses of the line
        Return value: None
 ******************************************************************************/
-void LCD_Address_Set(u16 x1,u16 y1,u16 x2,u16 y2)
+RAMFUNC void LCD_Address_Set(u16 x1,u16 y1,u16 x2,u16 y2)
 {
 	if(USE_HORIZONTAL==0)
 	{
@@ -205,6 +207,9 @@ void Lcd_Init(void)
 	gpio_init(GPIOB, GPIO_MODE_OUT_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_2);
 
 	spi_config();
+#if LCD_PIXELS_DMA
+	rcu_periph_clock_enable(RCU_DMA0);
+#endif
 
 #elif SPI0_CFG == 2
     rcu_periph_clock_enable(RCU_DMA0);
@@ -365,7 +370,8 @@ void LCD_Clear(u16 Color)
 void LCD_ShowChinese(u16 x,u16 y,u8 index,u8 size,u16 color)	
 {  
 	u8 i,j;
-	u8 *temp,size1;
+	const u8 *temp;
+	u8 size1;
 	if(size==16){temp=Hzk16;}//选择字号
 	if(size==32){temp=Hzk32;}
   LCD_Address_Set(x,y,x+size-1,y+size-1); //设置一个汉字的区域
@@ -394,7 +400,7 @@ void LCD_ShowChinese(u16 x,u16 y,u8 index,u8 size,u16 color)
        Entry data: x, y starting coordinates
        Return value: None
 ******************************************************************************/
-void LCD_DrawPoint(u16 x,u16 y,u16 color)
+RAMFUNC void LCD_DrawPoint(u16 x,u16 y,u16 color)
 {
 	LCD_Address_Set(x,y,x,y);//设置光标位置 
 	LCD_WR_DATA(color);
@@ -418,7 +424,7 @@ void LCD_DrawPoint_big(u16 x,u16 y,u16 color)
                    xend, yend termination coordinates
        Return value: None
 ******************************************************************************/
-void LCD_Fill(u16 xsta,u16 ysta,u16 xend,u16 yend,u16 color)
+RAMFUNC void LCD_Fill(u16 xsta,u16 ysta,u16 xend,u16 yend,u16 color)
 {          
 	u16 i,j; 
 	LCD_Address_Set(xsta,ysta,xend,yend);      //设置光标位置 
@@ -581,15 +587,31 @@ void LCD_ShowString(u16 x,u16 y,const u8 *p,u16 color)
 
 
 /******************************************************************************
-	   Function description: display numbers
-       Entry data: base m, n exponent
+	   Function description: display a line of text through one address window
+       Entry data: x, y starting point coordinates
+                   s text, cut at the right edge instead of wrapping
        Return value: None
 ******************************************************************************/
-u32 mypow(u8 m,u8 n)
+void LCD_ShowText(u16 x,u16 y,const char *s,u16 color)
 {
-	u32 result=1;	 
-	while(n--)result*=m;    
-	return result;
+	const u8 *glyph[LCD_W/8];	//1608 font rows of every character
+	u8 n,pos,c,t,temp;
+	if(y>LCD_H-16)return;
+	for(n=0;s[n]&&n<LCD_W/8&&x+8*n<=LCD_W-16;n++)	//Same edge as LCD_ShowChar
+		glyph[n]=asc2_1608+(u16)(s[n]-' ')*16;
+	if(!n)return;
+	LCD_Address_Set(x,y,x+8*n-1,y+16-1);
+	for(pos=0;pos<16;pos++)	//One pixel row across the whole line at a time
+		for(c=0;c<n;c++)
+		{
+			temp=glyph[c][pos];
+			for(t=0;t<8;t++)
+			{
+				if(temp&0x01)LCD_WR_DATA(color);
+				else LCD_WR_DATA(BACK_COLOR);
+				temp>>=1;
+			}
+		}
 }
 
 
@@ -602,22 +624,18 @@ u32 mypow(u8 m,u8 n)
 ******************************************************************************/
 void LCD_ShowNum(u16 x,u16 y,u16 num,u8 len,u16 color)
 {         	
-	u8 t,temp;
-	u8 enshow=0;
-	for(t=0;t<len;t++)
-	{
-		temp=(num/mypow(10,len-t-1))%10;
-		if(enshow==0&&t<(len-1))
-		{
-			if(temp==0)
-			{
-				LCD_ShowChar(x+8*t,y,' ',0,color);
-				continue;
-			}else enshow=1; 
-		 	 
-		}
-	 	LCD_ShowChar(x+8*t,y,temp+48,0,color); 
-	}
+	char buf[LCD_W/8+1];
+	char out[12];
+	const char *digits;
+	u8 t,pad=0;
+	if(len>LCD_W/8)len=LCD_W/8;	//The rest would be off the screen
+	if(len>5){pad=len-5;len=5;}	//u16 has at most 5 digits
+	for(t=0;t<pad;t++)buf[t]=' ';
+	digits=Fmt_Udec(out,num,len,'0')-len;	//Keep the low len digits
+	for(t=0;t+1<len&&digits[t]=='0';t++)buf[pad+t]=' ';	//Blank leading zeros
+	for(;t<len;t++)buf[pad+t]=digits[t];
+	buf[pad+len]=0;
+	LCD_ShowText(x,y,buf,color);
 } 
 
 
@@ -630,21 +648,22 @@ void LCD_ShowNum(u16 x,u16 y,u16 num,u8 len,u16 color)
 ******************************************************************************/
 void LCD_ShowNum1(u16 x,u16 y,float num,u8 len,u16 color)
 {         	
-	u8 t,temp;
-	// u8 enshow=0;
+	char buf[LCD_W/8+2];
+	char out[12];
+	const char *digits;
+	u8 t,n=0;
 	u16 num1;
 	num1=num*100;
+	if(len>LCD_W/8)len=LCD_W/8;
+	for(;len>5;len--)buf[n++]='0';
+	digits=Fmt_Udec(out,num1,len,'0')-len;	//Two decimals, zero padded
 	for(t=0;t<len;t++)
 	{
-		temp=(num1/mypow(10,len-t-1))%10;
-		if(t==(len-2))
-		{
-			LCD_ShowChar(x+8*(len-2),y,'.',0,color);
-			t++;
-			len+=1;
-		}
-	 	LCD_ShowChar(x+8*t,y,temp+48,0,color);
+		if(t==(len-2))buf[n++]='.';
+		buf[n++]=digits[t];
 	}
+	buf[n]=0;
+	LCD_ShowText(x,y,buf,color);
 }
 
 
@@ -672,4 +691,130 @@ void LCD_ShowLogo(void)
 	{
 		LCD_WR_DATA8(logo_bmp[i]);
 	}			
-}
\ No newline at end of file
+}
+
+#if SPI0_CFG == 1 && LCD_PIXELS_DMA
+static int pixels_dma; //A transfer is running on DMA0 channel 2
+#endif
+
+/******************************************************************************
+	   Function description: Start a pixel transaction, see lcd/pixels.h
+       Entry data: x1, y1, x2, y2 corners of the window to fill
+       Return value: None
+******************************************************************************/
+void LCD_PixelsBegin(uint16_t x1,uint16_t y1,uint16_t x2,uint16_t y2)
+{
+	LCD_Address_Set(x1,y1,x2,y2);
+	OLED_DC_Set();//Write data
+	OLED_CS_Clr();
+}
+
+
+/******************************************************************************
+	   Function description: Send pixel bytes in the open window, by DMA
+	                         when enabled, returning before they are out
+       Entry data: buf bytes to send, len their count
+       Return value: None
+******************************************************************************/
+void LCD_PixelsWrite(const uint8_t *buf,uint32_t len)
+{
+#if SPI0_CFG == 1 && LCD_PIXELS_DMA
+	dma_parameter_struct dma_init_struct;
+
+	LCD_PixelsWait();
+	if(len==0) return;
+	dma_deinit(DMA0, DMA_CH2);
+	dma_struct_para_init(&dma_init_struct);
+	dma_init_struct.periph_addr  = (uint32_t)&SPI_DATA(SPI0);
+	dma_init_struct.memory_addr  = (uint32_t)buf;
+	dma_init_struct.direction    = DMA_MEMORY_TO_PERIPHERAL;
+	dma_init_struct.memory_width = DMA_MEMORY_WIDTH_8BIT;
+	dma_init_struct.periph_width = DMA_PERIPHERAL_WIDTH_8BIT;
+	dma_init_struct.priority     = DMA_PRIORITY_LOW;
+	dma_init_struct.number       = len;	//Callers stay far below 65535
+	dma_init_struct.periph_inc   = DMA_PERIPH_INCREASE_DISABLE;
+	dma_init_struct.memory_inc   = DMA_MEMORY_INCREASE_ENABLE;
+	dma_init(DMA0, DMA_CH2, &dma_init_struct);
+	dma_circulation_disable(DMA0, DMA_CH2);
+	dma_memory_to_memory_disable(DMA0, DMA_CH2);
+
+	pixels_dma=1;
+	dma_channel_enable(DMA0, DMA_CH2);
+	spi_dma_enable(SPI0, SPI_DMA_TRANSMIT);
+#elif SPI0_CFG == 1
+	//Received bytes are not read, LCD_PixelsEnd clears the overrun
+	while(len--)
+	{
+		while(!(SPI_STAT(SPI0)&SPI_FLAG_TBE));
+		SPI_DATA(SPI0)=*buf++;
+	}
+#else
+	while(len--)
+	{
+		LCD_Writ_Bus(*buf++);
+	}
+#endif
+}
+
+
+/******************************************************************************
+	   Function description: Send count pixels of one color in the open window
+       Entry data: color RGB565, count pixels
+       Return value: None
+******************************************************************************/
+void LCD_PixelsFill(uint16_t color,uint32_t count)
+{
+#if SPI0_CFG == 1
+	LCD_PixelsWait();
+	while(count--)
+	{
+		while(!(SPI_STAT(SPI0)&SPI_FLAG_TBE));
+		SPI_DATA(SPI0)=color>>8;
+		while(!(SPI_STAT(SPI0)&SPI_FLAG_TBE));
+		SPI_DATA(SPI0)=color;
+	}
+#else
+	while(count--)
+	{
+		LCD_WR_DATA(color);
+	}
+#endif
+}
+
+
+/******************************************************************************
+	   Function description: Wait until the DMA of LCD_PixelsWrite is done
+       Entry data: None
+       Return value: None
+******************************************************************************/
+void LCD_PixelsWait(void)
+{
+#if SPI0_CFG == 1 && LCD_PIXELS_DMA
+	if(!pixels_dma) return;
+	while(!dma_flag_get(DMA0, DMA_CH2, DMA_FLAG_FTF));
+	spi_dma_disable(SPI0, SPI_DMA_TRANSMIT);
+	dma_channel_disable(DMA0, DMA_CH2);
+	dma_flag_clear(DMA0, DMA_CH2, DMA_FLAG_G);
+	pixels_dma=0;
+#endif
+}
+
+
+/******************************************************************************
+	   Function description: End a pixel transaction once the last byte is out
+       Entry data: None
+       Return value: None
+******************************************************************************/
+void LCD_PixelsEnd(void)
+{
+	LCD_PixelsWait();
+#if SPI0_CFG == 1
+	while(!(SPI_STAT(SPI0)&SPI_FLAG_TBE));
+	while(SPI_STAT(SPI0)&SPI_FLAG_TRANS);
+	//Reading DATA then STAT clears RBNE and the overrun, or the next
+	//LCD_Writ_Bus would take a stale byte as its own
+	(void)SPI_DATA(SPI0);
+	(void)SPI_STAT(SPI0);
+#endif
+	OLED_CS_Set();
+}
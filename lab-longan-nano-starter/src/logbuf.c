@@ -0,0 +1,141 @@
+#include "logbuf.h"
+#include <string.h>
+#include "tick.h"
+
+// Records are packed into a ring of sectors. Only whole sectors are ever
+// written, so the file stays sector aligned and FatFs hands every write
+// straight to disk_write as one multi-block transfer, no read-modify-write.
+
+static uint8_t *ring;    // sectors from Log_Open, NULL while closed
+static uint32_t nsect;   // sectors in the ring
+static uint32_t fill;    // sector being filled
+static uint32_t pos;     // bytes used in it
+static uint32_t first;   // oldest full sector
+static uint32_t full;    // full sectors waiting for the sink
+static uint16_t seq;
+static LogStats stats;
+
+/**
+ * @param[in] mem buffer of at least two sectors, LOG_BUFFER_SECTORS is the
+ * default, and it must outlive the log
+ * @returns 1 if the sink opened, 0 leaves logging off
+ * */
+int Log_Open(void *mem, uint32_t size) {
+  memset(&stats, 0, sizeof stats);
+  ring = NULL;
+  nsect = size / LOG_SECTOR;
+  fill = pos = first = full = 0;
+  seq = 0;
+  if (!mem || nsect < 2 || !Log_SinkOpen())
+    return 0;
+  ring = mem;
+  return 1;
+}
+
+// Zero the rest of the open sector and queue it for the sink
+static void seal(void) {
+  memset(ring + fill * LOG_SECTOR + pos, 0, LOG_SECTOR - pos);
+  full++;
+  fill = (fill + 1) % nsect;
+  pos = 0;
+}
+
+/**
+ * Copy a record into the buffer, nothing touches the card here.
+ * @param[in] len payload bytes, at most 255
+ * @returns 1 if buffered, 0 if the log is off or the buffer is full
+ * */
+int Log_Record(LogType type, const void *payload, uint32_t len) {
+  uint32_t start = prof_cycles();
+  uint32_t need = sizeof(LogHeader) + len;
+  LogHeader h;
+
+  if (!ring || len > 255)
+    return 0;
+  if (pos + need > LOG_SECTOR) {
+    if (full + 2 > nsect) { // sealing would leave no sector to fill
+      stats.dropped++;
+      seq++;
+      return 0;
+    }
+    seal();
+  }
+  h.type = type;
+  h.len = len;
+  h.seq = seq++;
+  h.ms = Tick_Ms();
+  memcpy(ring + fill * LOG_SECTOR + pos, &h, sizeof h);
+  memcpy(ring + fill * LOG_SECTOR + pos + sizeof h, payload, len);
+  pos += need;
+  stats.records++;
+  stats.record_cycles += prof_cycles() - start;
+  return 1;
+}
+
+/**
+ * @returns nonzero once LOG_FLUSH_SECTORS full sectors are waiting
+ * */
+int Log_Pending(void) { return ring && full >= LOG_FLUSH_SECTORS; }
+
+// Hand up to max full sectors to the sink in one write. A run stops at
+// the end of the ring; on an error the sectors are dropped, not retried.
+static void write_run(uint32_t max) {
+  uint32_t n = full < max ? full : max;
+
+  if (n > nsect - first)
+    n = nsect - first;
+  if (!n)
+    return;
+  if (Log_SinkWrite(ring + first * LOG_SECTOR, n))
+    stats.sectors += n;
+  else
+    stats.errors++;
+  stats.writes++;
+  first = (first + n) % nsect;
+  full -= n;
+}
+
+/**
+ * Write up to max full sectors, at most LOG_FLUSH_SECTORS. Call from frame
+ * idle time when Log_Pending says so, with max sized to the time left
+ * before the next logic tick; the open sector is left alone.
+ * */
+void Log_Flush(uint32_t max) {
+  uint32_t start = prof_cycles(), t;
+
+  if (!ring)
+    return;
+  write_run(max < LOG_FLUSH_SECTORS ? max : LOG_FLUSH_SECTORS);
+  t = prof_cycles() - start;
+  stats.flush_cycles += t;
+  if (t > stats.flush_worst)
+    stats.flush_worst = t;
+}
+
+/**
+ * Pad the open sector, write everything and sync the file, for pause and
+ * exit. Each call costs the unused rest of a sector in the file.
+ * */
+void Log_Sync(void) {
+  if (!ring)
+    return;
+  if (pos)
+    seal();
+  while (full)
+    write_run(full);
+  Log_SinkSync();
+  stats.syncs++;
+}
+
+/**
+ * Sync and close the sink, later records are ignored until Log_Open.
+ * */
+void Log_Close(void) {
+  if (!ring)
+    return;
+  Log_Sync();
+  Log_SinkClose();
+  ring = NULL;
+}
+
+const LogStats *Log_Stats(void) { return &stats; }
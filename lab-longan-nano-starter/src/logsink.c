@@ -0,0 +1,98 @@
+#include "arena.h"
+#include "fatfs/ff.h"
+#include "logbuf.h"
+
+// LOG_FILE on the card behind src/logbuf.c. The volume stays mounted for
+// the life of the log, so nothing else may mount or reinitialize the card
+// until Log_Close.
+
+static FATFS *fs;
+static FIL *fil;
+
+// Zero a freshly expanded file so the sectors not yet written read as
+// LOG_PAD, then rewind
+static int zero_fill(void) {
+  ArenaMark mark = Arena_Mark();
+  uint8_t *zero = Arena_Alloc(LOG_FLUSH_SECTORS * LOG_SECTOR);
+  int ok = zero != 0;
+  UINT bw;
+
+  for (uint32_t s = 0; ok && s < LOG_PREALLOC_SECTORS; s += LOG_FLUSH_SECTORS) {
+    uint32_t n = LOG_PREALLOC_SECTORS - s;
+    if (n > LOG_FLUSH_SECTORS)
+      n = LOG_FLUSH_SECTORS;
+    ok = f_write(fil, zero, n * LOG_SECTOR, &bw) == FR_OK &&
+         bw == n * LOG_SECTOR;
+  }
+  Arena_Reset(mark);
+  return ok && f_sync(fil) == FR_OK && f_lseek(fil, 0) == FR_OK;
+}
+
+// Seek to the first sector never written. Every sealed sector starts with
+// a record header and the preallocated ones are zero, so a binary search
+// on the type byte finds it in a few reads. A sector cut short rounds up.
+static int seek_end(void) {
+  uint32_t lo = 0, hi = (f_size(fil) + LOG_SECTOR - 1) / LOG_SECTOR;
+  uint8_t type;
+  UINT br;
+
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (f_lseek(fil, (FSIZE_t)mid * LOG_SECTOR) != FR_OK ||
+        f_read(fil, &type, 1, &br) != FR_OK || br != 1)
+      return 0;
+    if (type != LOG_PAD)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return f_lseek(fil, (FSIZE_t)lo * LOG_SECTOR) == FR_OK;
+}
+
+/**
+ * Mount the card and open LOG_FILE after its last record. A new file is
+ * preallocated with LOG_PREALLOC_SECTORS in one contiguous run, so the
+ * flushes only write data sectors; without such a run it grows as it
+ * goes. The FatFs objects come from the arena; the caller resets its mark
+ * if this fails.
+ * @returns 1 if the file is open and sector aligned
+ * */
+int Log_SinkOpen(void) {
+  fs = Arena_Alloc(sizeof(FATFS));
+  fil = Arena_Alloc(sizeof(FIL));
+  if (!fs || !fil || f_mount(fs, "", 1) != FR_OK)
+    return 0;
+  if (f_open(fil, LOG_FILE, FA_READ | FA_WRITE | FA_OPEN_ALWAYS) != FR_OK) {
+    f_mount(0, "", 0);
+    return 0;
+  }
+  if (f_size(fil) == 0 &&
+      f_expand(fil, (FSIZE_t)LOG_PREALLOC_SECTORS * LOG_SECTOR, 1) == FR_OK &&
+      !zero_fill()) {
+    f_close(fil);
+    f_mount(0, "", 0);
+    return 0;
+  }
+  if (!seek_end()) {
+    f_close(fil);
+    f_mount(0, "", 0);
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * @returns 1 if all sectors were written
+ * */
+int Log_SinkWrite(const void *data, uint32_t sectors) {
+  UINT bw;
+  return f_write(fil, data, sectors * LOG_SECTOR, &bw) == FR_OK &&
+         bw == sectors * LOG_SECTOR;
+}
+
+int Log_SinkSync(void) { return f_sync(fil) == FR_OK; }
+
+void Log_SinkClose(void) {
+  f_close(fil);
+  f_mount(0, "", 0);
+}
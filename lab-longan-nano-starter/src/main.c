@@ -1,19 +1,42 @@
+#include "arena.h"
 #include "assembly/example.h"
+#include "fatfs/ffstream.h"
+#include "fatfs/tf_card.h"
+#include "fmt.h"
+#include "framestats.h"
+#include "frametime.h"
+#include "input.h"
+#include "latency.h"
 #include "lcd/lcd.h"
+#include "logbuf.h"
 #include "math.h"
-#include "stdio.h"
+#include "memstat.h"
+#include "pack.h"
+#include "profiler.h"
+#include "ramfunc.h"
+#include "sampler.h"
+#include "scheduler.h"
+#include "serial.h"
 #include "utils.h"
+#include "video.h"
 
 // Helper macro
 #define min(a, b) (((a) < (b)) ? (a) : (b))
 
 // Game Constants
 #define MAX_ENEMIES 3
+// Pool capacities requested from the arena, see scene_pools
 #define MAX_BOSS_BULLETS 20          // Bullets spawned by the central boss site
 #define MAX_REGULAR_ENEMY_BULLETS 35 // Bullets spawned by enemies
 #define MAX_PLAYER_BULLETS 300
 
-#define PLAYER_SPEED 3
+// Player motion in Q8 fixed point (1/256 px) per logic tick
+#define PLAYER_FRAC_BITS 8
+#define PLAYER_START_SPEED 256 // first tick of a press moves a whole pixel
+#define PLAYER_MAX_SPEED 384
+#define PLAYER_FOCUS_SPEED 128 // top speed under BUTTON_2, past the first tick
+#define PLAYER_ACCEL 32
+#define PLAYER_DECEL 96
 
 #define ENEMY_WIDTH 4
 #define ENEMY_HEIGHT 4
@@ -47,9 +70,6 @@
 #define COLLISION_THRESHOLD_PLAYER_BULLET_ENEMY                                \
   (ENEMY_CENTER_OFFSET + PLAYER_BULLET_CENTER_OFFSET)
 
-#define BUTTON_ACTION_COOLDOWN_TICKS                                           \
-  ((SystemCoreClock / 4 / 1000) * 300) // 300 ms in timer ticks
-
 // Bullet type
 typedef enum {
   BULLET_TYPE_CIRCLE,   // white, circle, straight
@@ -109,30 +129,85 @@ typedef struct {
 } PlayerBullet;
 
 int player_x, player_y;
+int player_fx, player_fy; // sub-pixel position
+int player_vx, player_vy; // sub-pixel velocity
 int prev_player_x, prev_player_y;
 int player_size;
 int player_center_offset;
 
 Enemy enemies[MAX_ENEMIES];
 int enemy_count;
+uint32_t enemy_kills; // shot down by the player since boot
 int enemy_spawn_timer;
 int enemy_shoot_timer;
 
-BossBullet boss_bullets[MAX_BOSS_BULLETS];
+BossBullet *boss_bullets;
+int boss_bullet_cap;
 int boss_bullet_count;
 int boss_bullet_spawn_timer;
 
-EnemyBullet enemy_bullets[MAX_REGULAR_ENEMY_BULLETS];
+EnemyBullet *enemy_bullets;
+int enemy_bullet_cap;
 int enemy_bullet_count;
 
-PlayerBullet player_bullets[MAX_PLAYER_BULLETS];
+PlayerBullet *player_bullets;
+int player_bullet_cap;
 int player_bullet_count;
 int player_bullet_cooldown;
 
-#define MANY_BULLET 270
-EnemyBullet bullets[MANY_BULLET];
+#ifndef MANY_BULLET
+#define MANY_BULLET 270 // storm size, arena permitting
+#endif
+EnemyBullet *bullets;
+int many_bullet_cap;
 int many_bullets_count;
 
+// Boss phase: a spiral storm from the boss site in the storm pool, which
+// is asked for BOSS_STORM bullets and trimmed to what the arena has left
+// above SCENE_SCRATCH
+#ifndef BOSS_STORM
+#define BOSS_STORM 1500
+#endif
+#define BOSS_PHASE_KILLS 10  // kills in one gameplay scene that bring it on
+#define BOSS_STORM_TICKS 600 // logic ticks the boss keeps firing
+#define BOSS_STORM_RATE 3    // bullets fired per tick
+#define BOSS_STORM_SPEED 1.5f
+
+// Scenes size the arena pools differently and reuse the same memory. The
+// menu runs before the arena is set up and holds no pools.
+//
+// Pools never take the last SCENE_SCRATCH bytes, which the serial commands
+// allocate and give back in any scene: the 's' SD cache probe needs about
+// 6.3 KB (FATFS, FIL, four cache lines, a chunk and the read-ahead ring),
+// the 'v' player 5.7 KB. The rest covers the 8-byte rounding.
+#ifndef SCENE_SCRATCH
+#define SCENE_SCRATCH 6656
+#endif
+typedef enum {
+  SCENE_BOOM,     // opening bullet storm, no enemies
+  SCENE_GAMEPLAY, // enemies and the boss site
+  SCENE_BOSS,     // boss storm, no regular enemies
+} Scene;
+
+typedef struct {
+  int many_bullets, enemy_bullets, boss_bullets;
+} ScenePools;
+
+const ScenePools scene_pools[] = {
+    [SCENE_BOOM] = {MANY_BULLET, 0, 0},
+    [SCENE_GAMEPLAY] = {0, MAX_REGULAR_ENEMY_BULLETS, MAX_BOSS_BULLETS},
+    [SCENE_BOSS] = {BOSS_STORM, 0, 0},
+};
+
+Scene scene;
+ArenaMark scene_mark;  // arena top below the per-scene pools
+int scene_draining;    // no new shots, the scene ends once its pools are empty
+int scene_kills;       // enemies shot down since the scene was entered
+int boom = 80;         // opening storm ticks left to fire
+int boss_storm;        // boss phase ticks left to fire
+
+int diag_requested; // set by game_tick, shown between frames
+
 void Inp_init(void) {
   rcu_periph_clock_enable(RCU_GPIOA);
   rcu_periph_clock_enable(RCU_GPIOC);
@@ -144,33 +219,36 @@ void Inp_init(void) {
 }
 
 void IO_init(void) {
-  Inp_init(); // inport init
-  Lcd_Init(); // LCD init
+  Inp_init();    // inport init
+  Input_Init();  // edge interrupts and debounce
+  Lcd_Init();    // LCD init
+  Serial_Init(); // USART0 for diagnostics
 }
 
 void Board_self_test(void) {
   while (1) {
+    uint32_t held = Input_Snapshot();
     LCD_ShowString(60, 25, (u8 *)"TEST (25s)", WHITE);
-    if (Get_Button(JOY_LEFT)) {
+    if (held & (1 << JOY_LEFT)) {
       LCD_ShowString(5, 25, (u8 *)"L", BLUE);
     }
-    if (Get_Button(JOY_DOWN)) {
+    if (held & (1 << JOY_DOWN)) {
       LCD_ShowString(25, 45, (u8 *)"D", BLUE);
       LCD_ShowString(60, 25, (u8 *)"TEST", GREEN);
     }
-    if (Get_Button(JOY_UP)) {
+    if (held & (1 << JOY_UP)) {
       LCD_ShowString(25, 5, (u8 *)"U", BLUE);
     }
-    if (Get_Button(JOY_RIGHT)) {
+    if (held & (1 << JOY_RIGHT)) {
       LCD_ShowString(45, 25, (u8 *)"R", BLUE);
     }
-    if (Get_Button(JOY_CTR)) {
+    if (held & (1 << JOY_CTR)) {
       LCD_ShowString(25, 25, (u8 *)"C", BLUE);
     }
-    if (Get_Button(BUTTON_1)) {
+    if (held & (1 << BUTTON_1)) {
       LCD_ShowString(60, 5, (u8 *)"SW1", BLUE);
     }
-    if (Get_Button(BUTTON_2)) {
+    if (held & (1 << BUTTON_2)) {
       LCD_ShowString(60, 45, (u8 *)"SW2", BLUE);
     }
     delay_1ms(10);
@@ -178,8 +256,148 @@ void Board_self_test(void) {
   }
 }
 
+// Allocate up to *cap elements, shrinking *cap to what the arena can hold
+// with SCENE_SCRATCH still free
+void *alloc_pool(uint32_t elem_size, int *cap) {
+  uint32_t left = Arena_Size() - Arena_Used();
+  uint32_t room = left > SCENE_SCRATCH ? (left - SCENE_SCRATCH) / elem_size : 0;
+  if ((uint32_t)*cap > room)
+    *cap = room;
+  return *cap ? Arena_Alloc(*cap * elem_size) : NULL;
+}
+
+void enter_scene(Scene next) {
+  Arena_Reset(scene_mark);
+
+  many_bullet_cap = scene_pools[next].many_bullets;
+  bullets = alloc_pool(sizeof(EnemyBullet), &many_bullet_cap);
+  enemy_bullet_cap = scene_pools[next].enemy_bullets;
+  enemy_bullets = alloc_pool(sizeof(EnemyBullet), &enemy_bullet_cap);
+  boss_bullet_cap = scene_pools[next].boss_bullets;
+  boss_bullets = alloc_pool(sizeof(BossBullet), &boss_bullet_cap);
+
+  many_bullets_count = enemy_bullet_count = boss_bullet_count = 0;
+  scene = next;
+  scene_draining = 0;
+  scene_kills = 0;
+  boss_storm = next == SCENE_BOSS ? BOSS_STORM_TICKS : 0;
+}
+
+// Stop the gameplay scene for the boss phase. Enemies go at once, their
+// bullets fly off the screen first, since a pool is only given back to
+// the arena once none of it is left to erase.
+void leave_gameplay(void) {
+  for (int i = 0; i < MAX_ENEMIES; ++i)
+    enemies[i].alive = 0;
+  enemy_count = 0;
+  scene_draining = 1;
+}
+
+// Go on to the next scene once the current one has drained
+void scene_done(void) {
+  switch (scene) {
+  case SCENE_BOOM:
+    if (boom == 0 && many_bullets_count == 0)
+      enter_scene(SCENE_GAMEPLAY);
+    break;
+  case SCENE_GAMEPLAY:
+    if (scene_draining && enemy_bullet_count == 0 && boss_bullet_count == 0)
+      enter_scene(SCENE_BOSS);
+    break;
+  case SCENE_BOSS:
+    if (boss_storm == 0 && many_bullets_count == 0)
+      enter_scene(SCENE_GAMEPLAY);
+    break;
+  }
+}
+
+#if LOG_ENABLE
+// Open LOG_FILE with its buffer below the scene mark, or leave logging off
+void log_start(void) {
+  ArenaMark mark = Arena_Mark();
+  void *mem = Arena_Alloc(LOG_BUFFER_SECTORS * LOG_SECTOR);
+
+  if (!Log_Open(mem, LOG_BUFFER_SECTORS * LOG_SECTOR)) {
+    Serial_Write("LOG off\r\n");
+    Arena_Reset(mark);
+  }
+}
+
+void log_score(void) {
+  LogScore r = {Sched_Stats()->frames, enemy_kills, enemy_count};
+  Log_Record(LOG_SCORE, &r, sizeof r);
+}
+
+void log_ftime(void) {
+  const FrameTimeHist *h = Ftime_Get();
+  LogFtime r;
+
+  r.frames = h->frames;
+  r.p50_us = Ftime_Percentile(50);
+  r.p99_us = Ftime_Percentile(99);
+  r.worst_us = h->worst_us;
+  for (int i = 0; i < FTIME_BINS; ++i)
+    r.bins[i] = h->bins[i];
+  Log_Record(LOG_FTIME, &r, sizeof r);
+}
+
+void log_prof(void) {
+  LogProf r;
+
+  r.frame = Sched_Stats()->frames;
+  for (int p = 0; p < PROF_PHASES; ++p)
+    r.cycles[p] = Prof_AvgCycles(p);
+  Log_Record(LOG_PROF, &r, sizeof r);
+}
+
+// Periodic records, once per rendered frame
+void log_frame(void) {
+  uint32_t frame = Sched_Stats()->frames;
+
+  if (frame % LOG_PROF_FRAMES == 0)
+    log_prof();
+  if (frame % LOG_FTIME_FRAMES == 0)
+    log_ftime();
+}
+
+// The player may switch off at any pause, so everything goes to the card
+void log_pause(void) {
+  log_score();
+  log_ftime();
+  Log_Sync();
+}
+
+void log_dump(void) {
+  const LogStats *ls = Log_Stats();
+  Serial_Write("LOG records=");
+  Serial_WriteDec(ls->records);
+  Serial_Write(" dropped=");
+  Serial_WriteDec(ls->dropped);
+  Serial_Write(" sectors=");
+  Serial_WriteDec(ls->sectors);
+  Serial_Write(" writes=");
+  Serial_WriteDec(ls->writes);
+  Serial_Write(" errors=");
+  Serial_WriteDec(ls->errors);
+  Serial_Write(" rejects=");
+  Serial_WriteDec(disk_stats()->rejects);
+  Serial_Write(" syncs=");
+  Serial_WriteDec(ls->syncs);
+  Serial_Write(" record_cycles=");
+  Serial_WriteDec(ls->record_cycles);
+  Serial_Write(" flush_cycles=");
+  Serial_WriteDec(ls->flush_cycles);
+  uint32_t worst_us = ls->flush_worst / (SystemCoreClock / 1000000);
+  Serial_Write(" flush_worst_us=");
+  Serial_WriteDec(worst_us);
+  Serial_Write(" flush_worst_pct="); // of the frame budget
+  Serial_WriteDec(worst_us * SCHED_LOGIC_HZ / 10000);
+  Serial_Write("\r\n");
+}
+#endif
+
 void player_shoot(void) {
-  if (player_bullet_cooldown == 0 && player_bullet_count < MAX_PLAYER_BULLETS) {
+  if (player_bullet_cooldown == 0 && player_bullet_count < player_bullet_cap) {
     // Find nearest alive enemy
     int nearest_idx = -1;
     float nearest_dist_sq = 1e18f;
@@ -196,7 +414,7 @@ void player_shoot(void) {
         }
       }
     }
-    for (int i = 0; i < MAX_PLAYER_BULLETS; ++i) {
+    for (int i = 0; i < player_bullet_cap; ++i) {
       if (!player_bullets[i].alive) {
         float px_center = player_x + player_center_offset;
         float py_center = player_y + player_center_offset;
@@ -257,8 +475,8 @@ void enemies_shoot(void) {
   enemy_shoot_timer++;
   if (enemy_shoot_timer > ENEMY_SHOOT_INTERVAL) {
     for (int i = 0; i < MAX_ENEMIES; ++i) {
-      if (enemies[i].alive && enemy_bullet_count < MAX_REGULAR_ENEMY_BULLETS) {
-        for (int j = 0; j < MAX_REGULAR_ENEMY_BULLETS; ++j) {
+      if (enemies[i].alive && enemy_bullet_count < enemy_bullet_cap) {
+        for (int j = 0; j < enemy_bullet_cap; ++j) {
           if (!enemy_bullets[j].alive) {
             float ex_center = enemies[i].x + ENEMY_CENTER_OFFSET;
             float ey_center = enemies[i].y + ENEMY_CENTER_OFFSET;
@@ -328,9 +546,9 @@ void boss_shoot(void) {
   if (boss_bullet_spawn_timer > BOSS_BULLET_SPAWN_INTERVAL) {
     float angle_step = 2 * 3.1415926f / BOSS_BULLETS_PER_WAVE;
     for (int b = 0;
-         b < BOSS_BULLETS_PER_WAVE && boss_bullet_count < MAX_BOSS_BULLETS;
+         b < BOSS_BULLETS_PER_WAVE && boss_bullet_count < boss_bullet_cap;
          ++b) {
-      for (int i = 0; i < MAX_BOSS_BULLETS; ++i) {
+      for (int i = 0; i < boss_bullet_cap; ++i) {
         if (!boss_bullets[i].alive) {
           float angle = b * angle_step;
           boss_bullets[i].x = BOSS_CENTER_X - BULLET_VISUAL_OFFSET;
@@ -351,7 +569,7 @@ void boss_shoot(void) {
 
 void move_bullet(void) {
   // Update boss bullets
-  for (int i = 0; i < MAX_BOSS_BULLETS; ++i) {
+  for (int i = 0; i < boss_bullet_cap; ++i) {
     if (boss_bullets[i].alive) {
       boss_bullets[i].t += 1.0f;
       float spiral_growth_rate = 0.7f;
@@ -377,7 +595,7 @@ void move_bullet(void) {
   }
 
   // Update regular enemy bullets
-  for (int i = 0; i < MAX_REGULAR_ENEMY_BULLETS; ++i) {
+  for (int i = 0; i < enemy_bullet_cap; ++i) {
     if (enemy_bullets[i].alive) {
       if (enemy_bullets[i].type == BULLET_TYPE_STRAIGHT) {
         enemy_bullets[i].x += enemy_bullets[i].dx;
@@ -424,7 +642,7 @@ void move_bullet(void) {
   }
 
   // Update player bullets
-  for (int i = 0; i < MAX_PLAYER_BULLETS; ++i) {
+  for (int i = 0; i < player_bullet_cap; ++i) {
     if (player_bullets[i].alive) {
       player_bullets[i].x += player_bullets[i].dx;
       player_bullets[i].y += player_bullets[i].dy;
@@ -451,6 +669,11 @@ void move_bullet(void) {
                 COLLISION_THRESHOLD_PLAYER_BULLET_ENEMY) {
           enemies[target_enemy_idx].alive = 0;
           enemy_count--;
+          enemy_kills++;
+          scene_kills++;
+#if LOG_ENABLE
+          log_score();
+#endif
           player_bullets[i].alive = 0;
           player_bullet_count--;
         }
@@ -471,6 +694,8 @@ void draw(void) {
   // Draw player
   LCD_Fill(player_x, player_y, player_x + player_size - 1,
            player_y + player_size - 1, RED);
+  if (player_x != prev_player_x || player_y != prev_player_y)
+    Lat_Photon();
 
   // Draw enemies
   for (int i = 0; i < MAX_ENEMIES; ++i) {
@@ -495,7 +720,7 @@ void draw(void) {
   }
 
   // Draw boss bullets
-  for (int i = 0; i < MAX_BOSS_BULLETS; ++i) {
+  for (int i = 0; i < boss_bullet_cap; ++i) {
     if (boss_bullets[i].alive) {
       int bx_int = (int)boss_bullets[i].x;
       int by_int = (int)boss_bullets[i].y;
@@ -509,7 +734,7 @@ void draw(void) {
   }
 
   // Draw regular enemy bullets
-  for (int i = 0; i < MAX_REGULAR_ENEMY_BULLETS; ++i) {
+  for (int i = 0; i < enemy_bullet_cap; ++i) {
     if (enemy_bullets[i].alive) {
       int bx_int = (int)enemy_bullets[i].x;
       int by_int = (int)enemy_bullets[i].y;
@@ -534,7 +759,7 @@ void draw(void) {
   }
 
   // Draw player bullets
-  for (int i = 0; i < MAX_PLAYER_BULLETS; ++i) {
+  for (int i = 0; i < player_bullet_cap; ++i) {
     if (player_bullets[i].alive) {
       LCD_Fill((int)player_bullets[i].x, (int)player_bullets[i].y,
                (int)player_bullets[i].x + PLAYER_BULLET_DRAW_SIZE - 1,
@@ -552,31 +777,25 @@ void fps_entity(void) {
                           player_bullet_count + many_bullets_count;
   // diamond is 4 of line bullet
 
-  static uint64_t prev_frame_mtime_ns = 0;
-  uint32_t fps;
-  uint64_t tmp = get_timer_value(), current_frame_mtime_ns;
-  do {
-    current_frame_mtime_ns = get_timer_value();
-  } while (tmp == current_frame_mtime_ns);
-
-  uint64_t mtime_diff = current_frame_mtime_ns - prev_frame_mtime_ns;
-  if (mtime_diff > 0) {
-    uint32_t mtime_clk_freq = SystemCoreClock / 4;
-    if (mtime_clk_freq > 0)
-      fps = (uint32_t)(mtime_clk_freq / mtime_diff);
-    else
-      fps = 0; // SystemCoreClock not set or error
-  } else
-    fps = 99;
-
-  prev_frame_mtime_ns = current_frame_mtime_ns;
-
-  char entity_str[32];
-  char fps_str[32];
-  sprintf(entity_str, "Num: %03lu", (long unsigned int)entity_count);
-  sprintf(fps_str, "FPS: %02lu", (long unsigned int)fps);
-  LCD_ShowString(0, 0, (u8 *)entity_str, WHITE);
-  LCD_ShowString(0, 15, (u8 *)fps_str, WHITE);
+  Fstat_Push(entity_count);
+  const FrameStats *stats = Fstat_Get();
+
+  char line[16];
+  Fmt_Udec(Fmt_Str(line, "Num: "), stats->entities, 3, '0');
+  LCD_ShowText(0, 0, line, WHITE);
+  Fmt_Udec(Fmt_Str(line, "FPS: "), stats->fps_avg, 2, '0');
+  LCD_ShowText(0, 15, line, WHITE);
+
+  // Input-to-photon latency shares the profiler overlay toggle
+  static int lat_shown = 0;
+  if (Prof_OverlayOn()) {
+    Fmt_Udec(Fmt_Str(line, "Lat: "), Lat_Get()->avg_us / 1000, 2, '0');
+    LCD_ShowText(0, 30, line, WHITE);
+    lat_shown = 1;
+  } else if (lat_shown) {
+    LCD_Fill(0, 30, 8 * 8 - 1, 30 + 16 - 1, BLACK);
+    lat_shown = 0;
+  }
 }
 
 void erase_origin(void) {
@@ -595,7 +814,7 @@ void erase_origin(void) {
   }
 
   // Erase boss bullets
-  for (int i = 0; i < MAX_BOSS_BULLETS; ++i) {
+  for (int i = 0; i < boss_bullet_cap; ++i) {
     if (boss_bullets[i].prev_alive) {
       int prev_bx_int = (int)boss_bullets[i].prev_x;
       int prev_by_int = (int)boss_bullets[i].prev_y;
@@ -609,7 +828,7 @@ void erase_origin(void) {
   }
 
   // Erase enemy bullets
-  for (int i = 0; i < MAX_REGULAR_ENEMY_BULLETS; ++i) {
+  for (int i = 0; i < enemy_bullet_cap; ++i) {
     if (enemy_bullets[i].prev_alive) {
       int prev_bx_int = (int)enemy_bullets[i].prev_x;
       int prev_by_int = (int)enemy_bullets[i].prev_y;
@@ -635,7 +854,7 @@ void erase_origin(void) {
   }
 
   // Erase player bullets
-  for (int i = 0; i < MAX_PLAYER_BULLETS; ++i) {
+  for (int i = 0; i < player_bullet_cap; ++i) {
     if (player_bullets[i].prev_alive) {
       LCD_Fill((int)player_bullets[i].prev_x, (int)player_bullets[i].prev_y,
                (int)player_bullets[i].prev_x + PLAYER_BULLET_DRAW_SIZE - 1,
@@ -654,17 +873,17 @@ void store_state(void) {
     enemies[i].prev_y = enemies[i].y;
     enemies[i].prev_alive = enemies[i].alive;
   }
-  for (int i = 0; i < MAX_BOSS_BULLETS; ++i) {
+  for (int i = 0; i < boss_bullet_cap; ++i) {
     boss_bullets[i].prev_x = boss_bullets[i].x;
     boss_bullets[i].prev_y = boss_bullets[i].y;
     boss_bullets[i].prev_alive = boss_bullets[i].alive;
   }
-  for (int i = 0; i < MAX_REGULAR_ENEMY_BULLETS; ++i) {
+  for (int i = 0; i < enemy_bullet_cap; ++i) {
     enemy_bullets[i].prev_x = enemy_bullets[i].x;
     enemy_bullets[i].prev_y = enemy_bullets[i].y;
     enemy_bullets[i].prev_alive = enemy_bullets[i].alive;
   }
-  for (int i = 0; i < MAX_PLAYER_BULLETS; ++i) {
+  for (int i = 0; i < player_bullet_cap; ++i) {
     player_bullets[i].prev_x = player_bullets[i].x;
     player_bullets[i].prev_y = player_bullets[i].y;
     player_bullets[i].prev_alive = player_bullets[i].alive;
@@ -674,19 +893,611 @@ void store_state(void) {
 void draw_many_bullets(void);
 void update_many_bullets(void);
 void spawn_many_bullets(void);
+void spawn_boss_storm(void);
 void erase_many_bullets(void);
 void store_many_bullets(void);
 
+// Advance one axis velocity toward the held direction
+int axis_velocity(int v, int dir, int press, int max_speed) {
+  if (dir == 0) {
+    if (v > PLAYER_DECEL)
+      return v - PLAYER_DECEL;
+    if (v < -PLAYER_DECEL)
+      return v + PLAYER_DECEL;
+    return 0;
+  }
+  // From rest, reversing or pressed again while still slowing down, a
+  // whole pixel on this very tick, even under the focus cap
+  if (v * dir <= 0 || (press && v * dir < PLAYER_START_SPEED))
+    return dir * PLAYER_START_SPEED;
+  v += dir * PLAYER_ACCEL;
+  if (v > max_speed)
+    v = max_speed;
+  if (v < -max_speed)
+    v = -max_speed;
+  return v;
+}
+
+// held and pressed are Input_Snapshot masks, pressed the keys that went
+// down since the previous tick
+void move_player(uint32_t held, uint32_t pressed) {
+  int max_speed =
+      (held & (1 << BUTTON_2)) ? PLAYER_FOCUS_SPEED : PLAYER_MAX_SPEED;
+  int dir_x = !!(held & (1 << JOY_RIGHT)) - !!(held & (1 << JOY_LEFT));
+  int dir_y = !!(held & (1 << JOY_DOWN)) - !!(held & (1 << JOY_UP));
+  int press_x = pressed & (1 << (dir_x > 0 ? JOY_RIGHT : JOY_LEFT));
+  int press_y = pressed & (1 << (dir_y > 0 ? JOY_DOWN : JOY_UP));
+  int max_fx = (LCD_W - player_size) << PLAYER_FRAC_BITS;
+  int max_fy = (LCD_H - player_size) << PLAYER_FRAC_BITS;
+
+  player_vx = axis_velocity(player_vx, dir_x, press_x, max_speed);
+  player_vy = axis_velocity(player_vy, dir_y, press_y, max_speed);
+  player_fx += player_vx;
+  player_fy += player_vy;
+
+  // Stop dead against the screen edges
+  if (player_fx < 0 || player_fx > max_fx) {
+    player_fx = player_fx < 0 ? 0 : max_fx;
+    player_vx = 0;
+  }
+  if (player_fy < 0 || player_fy > max_fy) {
+    player_fy = player_fy < 0 ? 0 : max_fy;
+    player_vy = 0;
+  }
+  player_x = player_fx >> PLAYER_FRAC_BITS;
+  player_y = player_fy >> PLAYER_FRAC_BITS;
+}
+
+
+void game_tick(void) {
+  InputEvent ev;
+
+  Input_Settle();
+  while (Input_Poll(&ev)) {
+    // Joystick center toggles the profiler overlay, with BUTTON_2 held it
+    // opens the memory diagnostics page instead
+    if (ev.key == JOY_CTR && ev.pressed) {
+      if (Input_Held() & (1 << BUTTON_2))
+        diag_requested = 1;
+      else
+        Prof_ToggleOverlay();
+    }
+    // Time a press that starts the player moving from rest
+    if (ev.key <= JOY_UP && ev.pressed && player_vx == 0 && player_vy == 0)
+      Lat_Input(ev.stamp);
+  }
+
+  // Movement reads the raw pins so it reacts on the very next tick
+  uint32_t held = Input_Snapshot();
+  move_player(held, input_pressed);
+
+  // Player shoot, a discrete action so it goes through the debounce filter
+  if (Input_Held() & (1 << BUTTON_1)) {
+    player_shoot();
+  }
+
+  if (boom > 0) {
+    boom--;
+    spawn_many_bullets(); // for 256
+  }
+  if (boss_storm > 0) {
+    boss_storm--;
+    spawn_boss_storm();
+  }
+  update_many_bullets();
+
+  if (scene == SCENE_GAMEPLAY && !scene_draining) {
+    spawn_enemies();
+    enemies_shoot();
+    move_enemies();
+    boss_shoot();
+    if (scene_kills >= BOSS_PHASE_KILLS)
+      leave_gameplay();
+  }
+
+  move_bullet();
+}
+
+void dump_memory(void) {
+  const MemPool pools[] = {
+      {"player_bullets", player_bullet_cap, sizeof(PlayerBullet)},
+      {"many_bullets", many_bullet_cap, sizeof(EnemyBullet)},
+      {"enemy_bullets", enemy_bullet_cap, sizeof(EnemyBullet)},
+      {"boss_bullets", boss_bullet_cap, sizeof(BossBullet)},
+  };
+  Mem_Dump(pools, sizeof(pools) / sizeof(pools[0]));
+}
+
+// Memory page, the game is paused until the next joystick center press
+void diagnostics_screen(void) {
+  MemStats mem;
+  InputEvent ev;
+  char line[24];
+
+  LCD_Clear(BLACK);
+  LCD_ShowString(0, 0, (u8 *)"MEMORY   CTR:back", YELLOW);
+  while (1) {
+    Mem_Get(&mem);
+    char *p = Fmt_Udec(Fmt_Str(line, "Stack "), mem.stack_high, 5, ' ');
+    Fmt_Udec(Fmt_Str(p, "/"), mem.stack, 1, ' ');
+    LCD_ShowString(0, 16, (u8 *)line, WHITE);
+    p = Fmt_Udec(Fmt_Str(line, "Arena "), mem.arena_used, 5, ' ');
+    Fmt_Udec(Fmt_Str(p, "/"), mem.arena, 1, ' ');
+    LCD_ShowString(0, 32, (u8 *)line, WHITE);
+    Fmt_Udec(Fmt_Str(line, "Peak  "), mem.arena_high, 5, ' ');
+    LCD_ShowString(0, 48, (u8 *)line, WHITE);
+    Fmt_Udec(Fmt_Str(line, "Data+bss "), mem.data + mem.bss, 5, ' ');
+    LCD_ShowString(0, 64, (u8 *)line, WHITE);
+
+    Input_Settle();
+    while (Input_Poll(&ev)) {
+      if (ev.key == JOY_CTR && ev.pressed) {
+        LCD_Clear(BLACK);
+        return;
+      }
+    }
+    delay_1ms(100);
+  }
+}
+
+// Sequential SD read speed, polled and DMA, over the first SD_BENCH_SECTORS
+#define SD_BENCH_SECTORS 1024
+#define SD_BENCH_CHUNK 4 // sectors per disk_read, streamed with CMD18
+
+// Sector cache lines given to FatFs while the volume is mounted
+#ifndef SD_CACHE_WAYS
+#define SD_CACHE_WAYS 4
+#endif
+#define SD_CACHE_FILE "GAME.DAT" // looked up twice, need not exist
+#define SD_STREAM_RING 4             // sectors prefetched ahead of f_stream_read
+#define SD_STREAM_CHUNK 1024         // bytes per read call
+
+// Read all of SD_CACHE_FILE, streamed or plain, @returns KB/s, 0 if absent
+DWORD sd_read_file(FIL *fil, BYTE *chunk, BYTE *ring) {
+  uint64_t start = get_timer_value(), ticks;
+  UINT br;
+  FRESULT res;
+
+  res = ring ? f_stream_open(fil, SD_CACHE_FILE, ring, SD_STREAM_RING)
+             : f_open(fil, SD_CACHE_FILE, FA_READ);
+  if (res != FR_OK)
+    return 0;
+  do {
+    if (ring) {
+      res = f_stream_read(fil, chunk, SD_STREAM_CHUNK, &br);
+      f_stream_pump(fil, SD_STREAM_RING); // stands in for frame idle time
+    } else {
+      res = f_read(fil, chunk, SD_STREAM_CHUNK, &br);
+    }
+  } while (res == FR_OK && br == SD_STREAM_CHUNK);
+  ticks = get_timer_value() - start;
+  FSIZE_t size = f_size(fil);
+  if (ring)
+    f_stream_close(fil);
+  else
+    f_close(fil);
+  if (res != FR_OK || !ticks)
+    return 0;
+  return (DWORD)((uint64_t)size * (SystemCoreClock / 4) / 1024 / ticks);
+}
+
+// Mount, pin the FAT, repeat a path lookup through the sector cache and
+// time a plain and a streamed read of the same file
+void sd_cache_probe(void) {
+  ArenaMark mark = Arena_Mark();
+  FATFS *fs = Arena_Alloc(sizeof(FATFS));
+  FIL *fil = Arena_Alloc(sizeof(FIL));
+  void *lines = Arena_Alloc(SD_CACHE_WAYS * DISK_CACHE_LINE);
+  BYTE *chunk = Arena_Alloc(SD_STREAM_CHUNK);
+  BYTE *ring = Arena_Alloc(SD_STREAM_RING * 512);
+
+  if (!fs || !fil || !lines || !chunk || !ring) {
+    Serial_Write("SDCACHE no memory\r\n");
+    Arena_Reset(mark);
+    return;
+  }
+  disk_cache_init(lines, SD_CACHE_WAYS * DISK_CACHE_LINE);
+  if (f_mount(fs, "", 1) == FR_OK) {
+    disk_cache_pin(fs->fatbase, fs->fsize);
+    for (int i = 0; i < 2; ++i) {
+      if (f_open(fil, SD_CACHE_FILE, FA_READ) == FR_OK)
+        f_close(fil);
+    }
+    DWORD plain = sd_read_file(fil, chunk, 0);
+    const SDSTATS *sd = disk_stats();
+    DWORD streams = sd->streams, ring_hits = sd->ring_hits;
+    DWORD side_reads = sd->side_reads;
+    DWORD stream = sd_read_file(fil, chunk, ring);
+    Serial_Write("SDSTREAM file=" SD_CACHE_FILE " plain_kbps=");
+    Serial_WriteDec(plain);
+    Serial_Write(" stream_kbps=");
+    Serial_WriteDec(stream);
+    Serial_Write(" cmd18=");
+    Serial_WriteDec(sd->streams - streams);
+    Serial_Write(" ring_hits=");
+    Serial_WriteDec(sd->ring_hits - ring_hits);
+    Serial_Write(" cmd17=");
+    Serial_WriteDec(sd->side_reads - side_reads);
+    Serial_Write("\r\n");
+    f_mount(0, "", 0);
+  }
+
+  const CACHESTATS *cs = disk_cache_stats();
+  Serial_Write("SDCACHE ways=");
+  Serial_WriteDec(cs->ways);
+  Serial_Write(" hits=");
+  Serial_WriteDec(cs->hits);
+  Serial_Write(" misses=");
+  Serial_WriteDec(cs->misses);
+  Serial_Write(" bypass=");
+  Serial_WriteDec(cs->bypass);
+  Serial_Write(" evictions=");
+  Serial_WriteDec(cs->evictions);
+  Serial_Write(" pinned=");
+  Serial_WriteDec(cs->pinned);
+  Serial_Write("\r\n");
+  disk_cache_init(0, 0); // the lines go back to the arena
+  Arena_Reset(mark);
+}
+
+// Random sector reads across PACK_FILE through the cluster link map, then
+// one asset loaded the way the game would, as raw sectors if the pack is
+// in one piece
+#define SD_SEEK_READS 64
+void sd_pack_probe(void) {
+  ArenaMark mark = Arena_Mark();
+  FATFS *fs = Arena_Alloc(sizeof(FATFS));
+  FIL *fil = Arena_Alloc(sizeof(FIL));
+  BYTE *work = Arena_Alloc(512);
+  BYTE *buf = Arena_Alloc(512);
+  uint32_t total = 0, worst = 0;
+  PackEntry e;
+  UINT br;
+
+  if (!fs || !fil || !work || !buf || f_mount(fs, "", 1) != FR_OK) {
+    Arena_Reset(mark);
+    return;
+  }
+  if (Pack_Open(fil, PACK_FILE, work)) {
+    FSIZE_t span = f_size(fil) > 512 ? f_size(fil) - 512 : 1;
+    for (int i = 0; i < SD_SEEK_READS; ++i) {
+      FSIZE_t ofs = (FSIZE_t)((uint32_t)rand() * 2654435761u % span);
+      uint64_t t = get_timer_value();
+      f_read_at(fil, ofs, buf, 512, &br);
+      t = get_timer_value() - t;
+      total += (uint32_t)t;
+      if (t > worst)
+        worst = (uint32_t)t;
+    }
+    Serial_Write("SDSEEK file=" PACK_FILE " fragments=");
+    Serial_WriteDec(Pack_Fragments());
+    Serial_Write(" avg_us=");
+    Serial_WriteDec(total / SD_SEEK_READS / (SystemCoreClock / 4000000));
+    Serial_Write(" worst_us=");
+    Serial_WriteDec(worst / (SystemCoreClock / 4000000));
+    Serial_Write("\r\n");
+
+    // The 8x16 font, 3 sectors, if the pack has it
+    uint64_t t = get_timer_value();
+    uint32_t got = 0;
+    if (Pack_Find(PACK_FONT, 0, &e)) {
+      BYTE *font = Arena_Alloc(Pack_LoadSize(&e));
+      if (font)
+        got = Pack_Load(&e, font);
+    }
+    t = get_timer_value() - t;
+    Serial_Write("SDPACK start=");
+    Serial_WriteDec(Pack_StartSector());
+    Serial_Write(" font_bytes=");
+    Serial_WriteDec(got);
+    Serial_Write(" font_us=");
+    Serial_WriteDec((uint32_t)t / (SystemCoreClock / 4000000));
+    Serial_Write("\r\n");
+    Pack_Close();
+  }
+  f_mount(0, "", 0);
+  Arena_Reset(mark);
+}
+
+// Cutscene skipped by the joystick center
+int video_skip(void) {
+  InputEvent ev;
+
+  while (Input_Poll(&ev))
+    if (ev.key == JOY_CTR && ev.pressed)
+      return 1;
+  return 0;
+}
+
+// Play VIDEO_FILE full screen and report the throughput, e.g.
+// VIDEO file=INTRO.VID frames=200 shown=200 dropped=0 late=0 keys=7 end=1
+// fps_x10=200 kbps=39 start=... read_pct= lcd_pct= idle_pct=
+void play_video(void) {
+  ArenaMark mark = Arena_Mark();
+#if LOG_ENABLE
+  Log_Close(); // the player remounts the card, logging stays off
+#endif
+  FATFS *fs = Arena_Alloc(sizeof(FATFS));
+  FIL *fil = Arena_Alloc(sizeof(FIL));
+  uint8_t *mem = Arena_Alloc(VIDEO_MEM);
+  VideoStats st;
+
+  if (!fs || !fil || !mem) {
+    Serial_Write("VIDEO no memory\r\n");
+    Arena_Reset(mark);
+    return;
+  }
+  if (f_mount(fs, "", 1) != FR_OK) {
+    Serial_Write("VIDEO mount failed\r\n");
+    Arena_Reset(mark);
+    return;
+  }
+  if (!Video_Open(fil, VIDEO_FILE, mem)) {
+    Serial_Write("VIDEO no clip " VIDEO_FILE "\r\n"); // absent or not VID1
+  } else {
+    Input_Flush();
+    int done = Video_Play(video_skip, &st);
+    uint32_t start = Video_StartSector();
+    Video_Close();
+    uint32_t ms = st.ms ? st.ms : 1;
+    uint64_t cycles = st.cycles ? st.cycles : 1;
+    Serial_Write("VIDEO file=" VIDEO_FILE " frames=");
+    Serial_WriteDec(st.frames);
+    Serial_Write(" shown=");
+    Serial_WriteDec(st.shown);
+    Serial_Write(" dropped=");
+    Serial_WriteDec(st.dropped);
+    Serial_Write(" late=");
+    Serial_WriteDec(st.late);
+    Serial_Write(" keys=");
+    Serial_WriteDec(st.keys);
+    Serial_Write(done ? " end=1" : " end=0");
+    Serial_Write(" fps_x10=");
+    Serial_WriteDec(st.shown * 10000 / ms);
+    Serial_Write(" kbps=");
+    Serial_WriteDec((uint32_t)((uint64_t)st.sectors * 512 / ms));
+    Serial_Write(" start=");
+    Serial_WriteDec(start);
+    Serial_Write(" read_pct=");
+    Serial_WriteDec((uint32_t)(st.read_cycles * 100 / cycles));
+    Serial_Write(" lcd_pct=");
+    Serial_WriteDec((uint32_t)(st.wait_cycles * 100 / cycles));
+    Serial_Write(" idle_pct=");
+    Serial_WriteDec((uint32_t)(st.idle_cycles * 100 / cycles));
+    Serial_Write("\r\n");
+  }
+  f_mount(0, "", 0);
+  Arena_Reset(mark);
+  LCD_Clear(BLACK);
+  Input_Flush();
+}
+
+#if SD_CACHE_TRACE
+// One line per disk_read for tools/disksim.c
+void disk_cache_trace(DWORD sector, UINT count) {
+  Serial_Write("DT ");
+  Serial_WriteDec(sector);
+  Serial_PutChar(' ');
+  Serial_WriteDec(count);
+  Serial_Write("\r\n");
+}
+#endif
+
+#if SD_ASYNC
+// Time one disk_async_poll may take, the most a frame can be held up
+#ifndef SD_ASYNC_SLICE_US
+#define SD_ASYNC_SLICE_US 500
+#endif
+#define SD_ASYNC_REQS 2 // requests kept in flight by the benchmark
+
+DWORD async_next; // next sector the benchmark queues
+
+// Completion callback: refill the request with the next chunk
+void sd_async_done(SDREQ *req) {
+  if (req->state != SDREQ_DONE || async_next >= SD_BENCH_SECTORS)
+    return;
+  req->sector = async_next;
+  async_next += req->count;
+  disk_async_read(req);
+}
+
+// Read SD_BENCH_SECTORS through the queue in SD_ASYNC_SLICE_US slices
+void sd_async_benchmark(void) {
+  ArenaMark mark = Arena_Mark();
+  BYTE *buff = Arena_Alloc(SD_ASYNC_REQS * SD_BENCH_CHUNK * 512);
+  SDREQ req[SD_ASYNC_REQS];
+  uint32_t slices = 0, worst = 0;
+  uint64_t start = get_timer_value();
+
+  if (!buff) {
+    Serial_Write("SDASYNC no memory\r\n");
+    return;
+  }
+  async_next = 0;
+  for (int i = 0; i < SD_ASYNC_REQS; ++i) {
+    req[i].buff = buff + i * SD_BENCH_CHUNK * 512;
+    req[i].count = SD_BENCH_CHUNK;
+    req[i].done = sd_async_done;
+    req[i].state = SDREQ_IDLE;
+    req[i].sector = async_next;
+    async_next += SD_BENCH_CHUNK;
+    disk_async_read(&req[i]);
+  }
+  while (disk_async_pending()) {
+    uint64_t t = get_timer_value();
+    disk_async_poll(SD_ASYNC_SLICE_US);
+    t = get_timer_value() - t;
+    if (t > worst)
+      worst = (uint32_t)t;
+    slices++;
+  }
+  uint64_t ticks = get_timer_value() - start;
+  int ok = 1;
+  for (int i = 0; i < SD_ASYNC_REQS; ++i)
+    ok &= req[i].state == SDREQ_DONE;
+
+  Serial_Write("SDASYNC sectors=");
+  Serial_WriteDec(SD_BENCH_SECTORS);
+  Serial_Write(" kbps=");
+  Serial_WriteDec(ok && ticks ? (uint32_t)((uint64_t)SD_BENCH_SECTORS * 512 *
+                                           (SystemCoreClock / 4) / 1024 / ticks)
+                              : 0);
+  Serial_Write(" slices=");
+  Serial_WriteDec(slices);
+  Serial_Write(" worst_slice_us=");
+  Serial_WriteDec(worst / (SystemCoreClock / 4000000));
+  Serial_Write("\r\n");
+  Arena_Reset(mark);
+}
+#endif
+
+void sd_benchmark(void) {
+  ArenaMark mark = Arena_Mark();
+#if LOG_ENABLE
+  Log_Close(); // the benchmark remounts the card, logging stays off
+#endif
+  BYTE *buff = Arena_Alloc(SD_BENCH_CHUNK * 512);
+
+  if (!buff || (disk_initialize(0) & STA_NOINIT)) {
+    Serial_Write(buff ? "SDBENCH no card\r\n" : "SDBENCH no memory\r\n");
+    Arena_Reset(mark);
+    return;
+  }
+  Serial_Write("SDBENCH sectors=");
+  Serial_WriteDec(SD_BENCH_SECTORS);
+  Serial_Write(" poll_kbps=");
+  Serial_WriteDec(
+      disk_bench(0, buff, 0, SD_BENCH_SECTORS, SD_BENCH_CHUNK, 0));
+  Serial_Write(" dma_kbps=");
+  Serial_WriteDec(
+      disk_bench(0, buff, 0, SD_BENCH_SECTORS, SD_BENCH_CHUNK, 1));
+  Serial_Write("\r\n");
+  Arena_Reset(mark);
+
+#if SD_ASYNC
+  sd_async_benchmark();
+#endif
+  sd_cache_probe();
+  sd_pack_probe();
+
+  const SDSTATS *sd = disk_stats();
+  Serial_Write("SDCLK hz=");
+  Serial_WriteDec(sd->clock_hz);
+  Serial_Write(" div=");
+  Serial_WriteDec(sd->clock_div);
+  Serial_Write(" crc_errors=");
+  Serial_WriteDec(sd->crc_errors);
+  Serial_Write(" timeouts=");
+  Serial_WriteDec(sd->timeouts);
+  Serial_Write(" retries=");
+  Serial_WriteDec(sd->retries);
+  Serial_Write(" stepdowns=");
+  Serial_WriteDec(sd->stepdowns);
+  Serial_Write("\r\n");
+}
+
+// One-letter commands on USART0, polled once per frame
+void serial_commands(void) {
+  switch (Serial_GetChar()) {
+  case 'h':
+    Ftime_Dump();
+    break;
+  case 'r':
+    Ftime_Reset();
+    break;
+  case 'l':
+    Lat_Dump();
+    break;
+  case 'm':
+    dump_memory();
+    break;
+#if LOG_ENABLE
+  case 'w':
+    log_dump();
+    break;
+#endif
+  case 's':
+    sd_benchmark();
+    Sched_Init(); // the run blocks for seconds, do not count it as a frame
+    break;
+  case 'v':
+    play_video();
+    Sched_Init();
+    break;
+#if PROF_SAMPLER
+  case 'p':
+    Psamp_Dump();
+    Psamp_Reset();
+    break;
+#endif
+  default:
+    break;
+  }
+}
+
+// Scripted run: skip the menu, play BENCHMARK_FRAMES frames, dump, halt
+#ifdef BENCHMARK_FRAMES
+uint64_t bench_cycles; // cycles outside Sched_Idle over the whole run
+int bench_bullets;     // storm pool the arena granted
+
+void benchmark_finish(void) {
+  Serial_Write("BENCH ramfunc=");
+  Serial_WriteDec(RAMFUNC_ENABLE);
+  Serial_Write(" bullets=");
+  Serial_WriteDec(bench_bullets);
+  Serial_Write(" frames=");
+  Serial_WriteDec(Ftime_Get()->frames);
+  Serial_Write(" cycles_per_frame=");
+  Serial_WriteDec(bench_cycles / Ftime_Get()->frames);
+  Serial_Write("\r\n");
+  Ftime_Dump();
+#if LOG_ENABLE
+  log_pause();
+  log_dump();
+#endif
+#if PROF_SAMPLER
+  Psamp_Stop();
+  Psamp_Dump();
+#endif
+  Serial_Write("BENCHMARK DONE\r\n");
+  while (1)
+    Sched_Idle();
+}
+#endif
+
 extern int choice;
 
 int main(void) {
+  Mem_PaintStack(); // before anything else can grow the stack
   IO_init();
   LCD_Clear(BLACK);
   int default_choice = 0;
+#ifdef BENCHMARK_FRAMES
+  int mode = default_choice;
+#else
   int mode = start(default_choice);
+#endif
 
   // Player position
+  // Player bullets outlive every scene, so they sit below the scene mark
+  Arena_Init();
+#if VIDEO_INTRO
+  play_video(); // gives its buffers back before the pools are carved
+#endif
+  player_bullet_cap = MAX_PLAYER_BULLETS;
+  player_bullets = alloc_pool(sizeof(PlayerBullet), &player_bullet_cap);
+#if LOG_ENABLE
+  log_start();
+#endif
+  scene_mark = Arena_Mark();
+  enter_scene(SCENE_BOOM);
+#ifdef BENCHMARK_FRAMES
+  bench_bullets = many_bullet_cap;
+#endif
+
   player_x = 30, player_y = 30;
+  player_fx = player_x << PLAYER_FRAC_BITS;
+  player_fy = player_y << PLAYER_FRAC_BITS;
   player_size = 6 + mode - choice;
   player_center_offset = player_size / 2;
 
@@ -704,82 +1515,97 @@ int main(void) {
   prev_player_x = player_x;
   prev_player_y = player_y;
 
-  int boom = 80;
+  Prof_Init();
+  Sched_Init();
+  Input_Flush(); // drop edges left over from the menu
+#if PROF_SAMPLER
+  Psamp_Start(PROF_SAMPLER_HZ);
+#endif
 
   while (1) {
-    // --- GAME LOGIC PHASE ---
-    static uint64_t last_action_time_joy_left = 0;
-    static uint64_t last_action_time_joy_right = 0;
-    static uint64_t last_action_time_joy_up = 0;
-    static uint64_t last_action_time_joy_down = 0;
-    uint64_t current_time = get_timer_value();
-
-    // Handle player movement
-    if (Get_Button(JOY_LEFT) && player_x > 0 &&
-        (current_time - last_action_time_joy_left) >
-            BUTTON_ACTION_COOLDOWN_TICKS) {
-      player_x -= PLAYER_SPEED;
-      last_action_time_joy_left = current_time;
-    }
-    if (Get_Button(JOY_RIGHT) && player_x < LCD_W - player_size &&
-        (current_time - last_action_time_joy_right) >
-            BUTTON_ACTION_COOLDOWN_TICKS) {
-      player_x += PLAYER_SPEED;
-      last_action_time_joy_right = current_time;
-    }
-    if (Get_Button(JOY_UP) && player_y > 0 &&
-        (current_time - last_action_time_joy_up) >
-            BUTTON_ACTION_COOLDOWN_TICKS) {
-      player_y -= PLAYER_SPEED;
-      last_action_time_joy_up = current_time;
-    }
-    if (Get_Button(JOY_DOWN) && player_y < LCD_H - player_size &&
-        (current_time - last_action_time_joy_down) >
-            BUTTON_ACTION_COOLDOWN_TICKS) {
-      player_y += PLAYER_SPEED;
-      last_action_time_joy_down = current_time;
-    }
-
-    // Player shoot
-    if (Get_Button(BUTTON_1)) {
-      player_shoot();
+    if (diag_requested) {
+#if LOG_ENABLE
+      log_pause();
+#endif
+      diagnostics_screen();
+      diag_requested = 0;
+      Sched_Init(); // restart the clock so the pause is not counted as a frame
+      Input_Flush();
     }
 
-    if (boom > 0) {
-      boom--;
-      spawn_many_bullets(); // for 256
+    int ticks = Sched_Poll();
+    if (ticks == 0) {
+#if SD_ASYNC
+      // Queued SD reads get the idle time in slices, then the CPU sleeps
+      if (disk_async_pending()) {
+        PROF_SCOPE(PROF_DISK) disk_async_poll(SD_ASYNC_SLICE_US);
+        continue;
+      }
+#endif
+#if LOG_ENABLE
+      // Whole sectors of telemetry go to the card in one CMD25 write, as
+      // many as fit before the next logic tick is due
+      if (Log_Pending()) {
+        uint32_t fit = Sched_TimeLeft() / (SystemCoreClock / 4000000) /
+                       LOG_SECTOR_US;
+        if (fit) {
+          PROF_SCOPE(PROF_DISK) Log_Flush(fit);
+          continue;
+        }
+      }
+#endif
+      PROF_SCOPE(PROF_IDLE) Sched_Idle();
+      continue;
     }
-    update_many_bullets();
 
-    if (many_bullets_count == 0) {
-      spawn_enemies();
-      enemies_shoot();
-      move_enemies();
-      boss_shoot();
+    // --- GAME LOGIC PHASE ---
+    PROF_SCOPE(PROF_LOGIC) {
+      while (ticks--)
+        game_tick();
     }
 
-    move_bullet();
-
     // --- DRAW PHASE ---
-    fps_entity();
-    draw();
-    draw_many_bullets();
+    PROF_SCOPE(PROF_HUD) fps_entity();
+    PROF_SCOPE(PROF_DRAW) {
+      draw();
+      draw_many_bullets();
+    }
 
     // --- ERASE PHASE ---
-    erase_origin();
-    erase_many_bullets();
+    PROF_SCOPE(PROF_ERASE) {
+      erase_origin();
+      erase_many_bullets();
+    }
 
     // --- STORE STATE PHASE ---
-    store_state();
-    store_many_bullets();
+    PROF_SCOPE(PROF_STORE) {
+      store_state();
+      store_many_bullets();
+    }
 
-    delay_1ms(5);
+    // A scene is over once its last bullet has been erased
+    scene_done();
+
+    Prof_DrawOverlay();
+    Sched_FrameDone();
+    Prof_FrameEnd();
+    Ftime_Record();
+#if LOG_ENABLE
+    log_frame();
+#endif
+    serial_commands();
+#ifdef BENCHMARK_FRAMES
+    for (int p = 0; p < PROF_IDLE; ++p)
+      bench_cycles += Prof_Cycles(p, 1);
+    if (Ftime_Get()->frames >= BENCHMARK_FRAMES)
+      benchmark_finish();
+#endif
   }
 }
 
-void draw_many_bullets(void) {
+RAMFUNC void draw_many_bullets(void) {
   // Draw bullets at new
-  for (int i = 0; i < MANY_BULLET; ++i) {
+  for (int i = 0; i < many_bullet_cap; ++i) {
     if (bullets[i].alive) {
       int bx_int = (int)bullets[i].x;
       int by_int = (int)bullets[i].y;
@@ -793,12 +1619,13 @@ void draw_many_bullets(void) {
   }
 }
 
-void update_many_bullets(void) {
+RAMFUNC void update_many_bullets(void) {
 
   // Update bullets
-  for (int i = 0; i < MANY_BULLET; ++i) {
+  for (int i = 0; i < many_bullet_cap; ++i) {
     if (bullets[i].alive) {
       bullets[i].x += bullets[i].dx;
+      bullets[i].y += bullets[i].dy;
 
       if (bullets[i].x < -BULLET_STRAIGHT_DRAW_SIZE || bullets[i].x > LCD_W ||
           bullets[i].y < -BULLET_STRAIGHT_DRAW_SIZE || bullets[i].y > LCD_H) {
@@ -812,7 +1639,7 @@ void update_many_bullets(void) {
 void spawn_many_bullets(void) {
   // Spawn new bullets
   int timer = 0;
-  for (int i = 0; i < MANY_BULLET && timer < 5; ++i) {
+  for (int i = 0; i < many_bullet_cap && timer < 5; ++i) {
     if (!bullets[i].alive) {
       bullets[i].x = 1.0f;
       bullets[i].y = (float)(i % (LCD_H - 4) + 2);
@@ -826,8 +1653,30 @@ void spawn_many_bullets(void) {
   }
 }
 
-void store_many_bullets(void) {
-  for (int i = 0; i < MANY_BULLET; ++i) {
+// A turning spiral from the boss site into the storm pool
+void spawn_boss_storm(void) {
+  static float angle;
+  int fired = 0;
+
+  for (int i = 0; i < many_bullet_cap && fired < BOSS_STORM_RATE; ++i) {
+    if (!bullets[i].alive) {
+      bullets[i].x = BOSS_CENTER_X;
+      bullets[i].y = BOSS_CENTER_Y;
+      bullets[i].dx = BOSS_STORM_SPEED * cosf(angle);
+      bullets[i].dy = BOSS_STORM_SPEED * sinf(angle);
+      bullets[i].alive = 1;
+      angle += 2.4f; // about the golden angle, the arms fill in evenly
+      if (angle > 2 * 3.1415926f)
+        angle -= 2 * 3.1415926f;
+
+      fired++;
+      many_bullets_count++;
+    }
+  }
+}
+
+RAMFUNC void store_many_bullets(void) {
+  for (int i = 0; i < many_bullet_cap; ++i) {
     bullets[i].prev_x = bullets[i].x;
     bullets[i].prev_y = bullets[i].y;
     bullets[i].prev_alive = bullets[i].alive;
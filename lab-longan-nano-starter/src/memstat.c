@@ -0,0 +1,83 @@
+#include "memstat.h"
+#include "arena.h"
+#include "gd32vf103_libopt.h"
+#include "serial.h"
+
+// Region bounds from GD32VF103xB.lds
+extern uint32_t _data[], _edata[], __bss_start[], _end[];
+extern uint32_t __stack_start[], _sp[];
+
+static uint32_t boot_time; // mtime at main, mtime counts from reset
+
+/**
+ * Fill the stack below the caller with MEM_STACK_PAINT. Call first thing
+ * in main, before interrupts are enabled.
+ * */
+__attribute__((noinline)) void Mem_PaintStack(void) {
+  uint32_t *sp;
+  __asm__ volatile("mv %0, sp" : "=r"(sp));
+  boot_time = (uint32_t)get_timer_value();
+
+  // Leaf function: nothing below sp is live while the loop runs
+  for (uint32_t *p = __stack_start; p < sp; ++p)
+    *p = MEM_STACK_PAINT;
+}
+
+/**
+ * @returns deepest stack use in bytes; equal to the reserved size means
+ *          the stack ran into the arena
+ * */
+uint32_t Mem_StackHighWater(void) {
+  uint32_t *p = __stack_start;
+
+  while (p < _sp && *p == MEM_STACK_PAINT)
+    ++p;
+  return (uint32_t)((char *)_sp - (char *)p);
+}
+
+void Mem_Get(MemStats *stats) {
+  stats->boot_us = boot_time / (SystemCoreClock / 4000000);
+  stats->data = (char *)_edata - (char *)_data;
+  stats->bss = (char *)_end - (char *)__bss_start;
+  stats->arena = Arena_Size();
+  stats->arena_used = Arena_Used();
+  stats->arena_high = Arena_HighWater();
+  stats->stack = (char *)_sp - (char *)__stack_start;
+  stats->stack_high = Mem_StackHighWater();
+}
+
+static void dump_field(const char *name, uint32_t v) {
+  Serial_PutChar(' ');
+  Serial_Write(name);
+  Serial_PutChar('=');
+  Serial_WriteDec(v);
+}
+
+/**
+ * Print the SRAM budget for tools/mem_report.py.
+ * @param[in] pools arena pools to list with their capacities
+ * */
+void Mem_Dump(const MemPool *pools, int count) {
+  MemStats stats;
+
+  Mem_Get(&stats);
+  Serial_Write("MEM BEGIN");
+  dump_field("boot_us", stats.boot_us);
+  dump_field("data", stats.data);
+  dump_field("bss", stats.bss);
+  dump_field("arena", stats.arena);
+  dump_field("arena_used", stats.arena_used);
+  dump_field("arena_high", stats.arena_high);
+  dump_field("stack", stats.stack);
+  dump_field("stack_high", stats.stack_high);
+  Serial_Write("\r\n");
+  for (int i = 0; i < count; ++i) {
+    Serial_Write("POOL ");
+    Serial_Write(pools[i].name);
+    dump_field("cap", pools[i].cap);
+    dump_field("elem", pools[i].elem_size);
+    dump_field("bytes", pools[i].cap * pools[i].elem_size);
+    Serial_Write("\r\n");
+  }
+  Serial_Write("MEM END\r\n");
+}
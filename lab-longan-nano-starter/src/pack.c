@@ -0,0 +1,212 @@
+#include "pack.h"
+#include <stddef.h>
+#include <string.h>
+#include "fatfs/diskio.h"
+
+// FatFs is only used to open the pack. If the file is in one piece its
+// start sector is known from the cluster link map, and from then on every
+// read is a disk_read of whole sectors: the payload goes by DMA straight
+// into the caller's buffer, no seek, no FatFs sector buffer, no copy.
+// A fragmented pack is read through the same calls with fast seek.
+//
+// PACK_RLE16 payloads are a sequence of little-endian 16-bit tokens. A
+// token with bit 15 set is followed by one word to repeat (token & 0x7FFF)
+// times, otherwise it is followed by that many literal words. Pack_Load
+// decodes in place: the stored data is read to buf + slack and the output
+// written from buf never overtakes it.
+
+#define NO_SECTOR 0xFFFFFFFFu
+
+static DWORD clmt[PACK_CLMT_ITEMS];
+static FIL *pack;            // NULL while closed
+static uint8_t *work;        // one sector for the index and partial reads
+static uint32_t work_sector; // pack sector held in work
+static uint32_t start;       // LBA of the pack, 0 if reads go through FatFs
+static PackHeader head;
+
+// Whole sectors of the pack, sector counted from its start
+static int read_sectors(uint32_t sector, void *buf, uint32_t n) {
+  UINT br;
+
+  if (start)
+    return disk_read(0, buf, start + sector, n) == RES_OK;
+  return f_read_at(pack, (FSIZE_t)sector * PACK_SECTOR, buf,
+                   n * PACK_SECTOR, &br) == FR_OK &&
+         br == n * PACK_SECTOR;
+}
+
+// One pack sector through the work buffer, kept for the next call
+static const uint8_t *work_load(uint32_t sector) {
+  if (work_sector != sector) {
+    work_sector = NO_SECTOR;
+    if (!read_sectors(sector, work, 1))
+      return NULL;
+    work_sector = sector;
+  }
+  return work;
+}
+
+/**
+ * @param[in] fp file object, @param[in] buf one sector of work memory;
+ * both stay in use until Pack_Close
+ * @returns 1 if path is a pack of this version
+ * */
+int Pack_Open(FIL *fp, const char *path, uint8_t *buf) {
+  FRESULT res = f_fastseek_open(fp, path, clmt, PACK_CLMT_ITEMS);
+
+  pack = NULL;
+  if (res != FR_OK && res != FR_NOT_ENOUGH_CORE)
+    return 0;
+  pack = fp;
+  work = buf;
+  work_sector = NO_SECTOR;
+  start = f_start_sector(fp);
+  if (!work_load(0)) {
+    Pack_Close();
+    return 0;
+  }
+  memcpy(&head, work, sizeof head);
+  if (head.magic != PACK_MAGIC || head.version != PACK_VERSION ||
+      head.entry_size != sizeof(PackEntry) ||
+      (FSIZE_t)head.sectors * PACK_SECTOR > f_size(fp)) {
+    Pack_Close();
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * Binary search of the index, each probe reads at most one sector.
+ * @returns 1 and the entry in *e if the pack holds the asset
+ * */
+int Pack_Find(PackType type, uint16_t id, PackEntry *e) {
+  const uint32_t per_sector = PACK_SECTOR / sizeof(PackEntry);
+  uint32_t key = (uint32_t)type << 16 | id;
+  uint32_t lo = 0, hi = pack ? head.count : 0;
+
+  while (lo < hi) {
+    uint32_t mid = (lo + hi) / 2;
+    const uint8_t *s = work_load(head.index_sector + mid / per_sector);
+    if (!s)
+      return 0;
+    memcpy(e, s + mid % per_sector * sizeof *e, sizeof *e);
+    uint32_t k = (uint32_t)e->type << 16 | e->id;
+    if (k == key)
+      return 1;
+    if (k < key)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return 0;
+}
+
+/**
+ * @returns bytes of buffer Pack_Load needs for e: whole sectors of stored
+ * data after the slack, and at least the decoded size
+ * */
+uint32_t Pack_LoadSize(const PackEntry *e) {
+  uint32_t n = e->slack + (e->size + PACK_SECTOR - 1) / PACK_SECTOR *
+                              PACK_SECTOR;
+  return n > e->raw_size ? n : e->raw_size;
+}
+
+static int rle16_decode(uint8_t *out, const uint8_t *in, uint32_t size,
+                        uint32_t raw) {
+  const uint8_t *in_end = in + size;
+  uint8_t *end = out + raw;
+
+  while (in + 2 <= in_end) {
+    uint32_t t = in[0] | in[1] << 8;
+    uint32_t n = (t & 0x7FFF) * 2;
+    in += 2;
+    if (n > (uint32_t)(end - out))
+      return 0;
+    if (t & 0x8000) {
+      if (in + 2 > in_end)
+        return 0;
+      uint8_t lo = in[0], hi = in[1];
+      in += 2;
+      for (; n; n -= 2) {
+        *out++ = lo;
+        *out++ = hi;
+      }
+    } else {
+      if (n > (uint32_t)(in_end - in))
+        return 0;
+      while (n--) // out stays behind in, a forward copy is safe
+        *out++ = *in++;
+    }
+  }
+  return out == end;
+}
+
+/**
+ * Read a whole asset into buf, Pack_LoadSize(e) bytes of which may be
+ * written. Uncompressed payloads land there with one multi-sector read.
+ * @returns decoded size, 0 on error
+ * */
+uint32_t Pack_Load(const PackEntry *e, void *buf) {
+  uint8_t *dst = buf;
+
+  if (!pack || (e->comp != PACK_RAW && e->comp != PACK_RLE16))
+    return 0;
+  if (!read_sectors(e->sector, dst + e->slack,
+                    (e->size + PACK_SECTOR - 1) / PACK_SECTOR))
+    return 0;
+  if (e->comp == PACK_RLE16 &&
+      !rle16_decode(dst, dst + e->slack, e->size, e->raw_size))
+    return 0;
+  return e->raw_size;
+}
+
+/**
+ * Random access into an uncompressed asset, e.g. one row of a sprite
+ * sheet. Whole sectors go straight to buf, the ends through the work sector.
+ * @returns bytes read, clipped to the end of the asset, 0 on error
+ * */
+uint32_t Pack_Read(const PackEntry *e, uint32_t ofs, void *buf,
+                   uint32_t len) {
+  uint8_t *dst = buf;
+  uint32_t done = 0;
+
+  if (!pack || e->comp != PACK_RAW || ofs >= e->size)
+    return 0;
+  if (len > e->size - ofs)
+    len = e->size - ofs;
+  while (done < len) {
+    uint32_t sector = e->sector + ofs / PACK_SECTOR;
+    uint32_t at = ofs % PACK_SECTOR, n;
+    if (at == 0 && len - done >= PACK_SECTOR) {
+      n = (len - done) / PACK_SECTOR;
+      if (!read_sectors(sector, dst + done, n))
+        return 0;
+      n *= PACK_SECTOR;
+    } else {
+      const uint8_t *s = work_load(sector);
+      if (!s)
+        return 0;
+      n = PACK_SECTOR - at < len - done ? PACK_SECTOR - at : len - done;
+      memcpy(dst + done, s + at, n);
+    }
+    done += n;
+    ofs += n;
+  }
+  return done;
+}
+
+/**
+ * @returns LBA of the pack on the card, 0 if it is read through FatFs
+ * */
+uint32_t Pack_StartSector(void) { return pack ? start : 0; }
+
+/**
+ * @returns fragments of the open pack, 0 if seeks walk the FAT chain
+ * */
+uint32_t Pack_Fragments(void) { return pack ? f_fragments(pack) : 0; }
+
+void Pack_Close(void) {
+  if (pack)
+    f_close(pack);
+  pack = NULL;
+}
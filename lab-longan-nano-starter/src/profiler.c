@@ -0,0 +1,116 @@
+#include "profiler.h"
+#ifndef HOST_BUILD
+#include "lcd/lcd.h"
+#include "scheduler.h"
+#endif
+
+#define OVERLAY_H 3
+#define OVERLAY_Y (LCD_H - OVERLAY_H)
+
+static const char *const names[PROF_PHASES] = {
+    "logic", "hud", "draw", "erase", "store", "disk", "idle"};
+
+static uint32_t begin_cycles[PROF_PHASES];
+static uint32_t begin_instret[PROF_PHASES];
+static uint32_t cycles[PROF_HISTORY][PROF_PHASES];
+static uint32_t instret[PROF_HISTORY][PROF_PHASES];
+static uint32_t cur; // history slot of the frame being measured
+static int overlay_on, overlay_dirty;
+
+/**
+ * Make sure the cycle and instruction counters are running.
+ * */
+void Prof_Init(void) {
+#ifndef HOST_BUILD
+  __asm__ volatile("csrw 0x320, zero"); // mcountinhibit
+#endif
+}
+
+void Prof_Begin(ProfPhase phase) {
+  begin_instret[phase] = prof_instret();
+  begin_cycles[phase] = prof_cycles();
+}
+
+/**
+ * Close a scope; a phase entered several times in a frame accumulates.
+ * */
+void Prof_End(ProfPhase phase) {
+  uint32_t now = prof_cycles();
+  cycles[cur][phase] += now - begin_cycles[phase];
+  instret[cur][phase] += prof_instret() - begin_instret[phase];
+}
+
+/**
+ * Commit the current frame to the history ring and start a new one.
+ * */
+void Prof_FrameEnd(void) {
+  cur = (cur + 1) % PROF_HISTORY;
+  for (int p = 0; p < PROF_PHASES; ++p) {
+    cycles[cur][p] = 0;
+    instret[cur][p] = 0;
+  }
+}
+
+/**
+ * @param[in] frames_ago 1 for the last completed frame, up to PROF_HISTORY-1
+ * @returns cycles spent in phase during that frame
+ * */
+uint32_t Prof_Cycles(ProfPhase phase, int frames_ago) {
+  return cycles[(cur + PROF_HISTORY - frames_ago) % PROF_HISTORY][phase];
+}
+
+uint32_t Prof_Instret(ProfPhase phase, int frames_ago) {
+  return instret[(cur + PROF_HISTORY - frames_ago) % PROF_HISTORY][phase];
+}
+
+/**
+ * @returns mean cycles per frame over the completed frames in the ring
+ * */
+uint32_t Prof_AvgCycles(ProfPhase phase) {
+  uint32_t sum = 0;
+  for (int i = 1; i < PROF_HISTORY; ++i)
+    sum += Prof_Cycles(phase, i);
+  return sum / (PROF_HISTORY - 1);
+}
+
+const char *Prof_Name(ProfPhase phase) { return names[phase]; }
+
+void Prof_ToggleOverlay(void) {
+  overlay_on = !overlay_on;
+  overlay_dirty = 1;
+}
+
+int Prof_OverlayOn(void) { return overlay_on; }
+
+#ifndef HOST_BUILD
+/**
+ * Draw a stacked bar along the bottom edge, full width is one logic tick.
+ * */
+void Prof_DrawOverlay(void) {
+  static const u16 colors[PROF_PHASES] = {RED,    WHITE, GREEN, BLUE,
+                                          YELLOW, CYAN,  GRAY};
+  uint32_t budget = SystemCoreClock / SCHED_LOGIC_HZ / LCD_W; // cycles per pixel
+  int x = 0;
+
+  if (!overlay_on) {
+    if (overlay_dirty)
+      LCD_Fill(0, OVERLAY_Y, LCD_W - 1, LCD_H - 1, BLACK);
+    overlay_dirty = 0;
+    return;
+  }
+  overlay_dirty = 0;
+
+  for (int p = 0; p < PROF_PHASES && x < LCD_W; ++p) {
+    int w = Prof_AvgCycles(p) / budget;
+    if (w > LCD_W - x)
+      w = LCD_W - x;
+    if (w > 0)
+      LCD_Fill(x, OVERLAY_Y, x + w - 1, LCD_H - 1, colors[p]);
+    x += w;
+  }
+  if (x < LCD_W)
+    LCD_Fill(x, OVERLAY_Y, LCD_W - 1, LCD_H - 1, BLACK);
+}
+#else
+void Prof_DrawOverlay(void) {}
+#endif
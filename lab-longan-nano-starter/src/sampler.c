@@ -0,0 +1,125 @@
+#include "sampler.h"
+#include "gd32vf103_libopt.h"
+#include "profiler.h"
+#include "riscv_encoding.h"
+#include "serial.h"
+
+#define SLOT_MASK (PSAMP_SLOTS - 1)
+#define MAX_PROBE 8 // linear probe limit, bounds the handler runtime
+
+static uint32_t pcs[PSAMP_SLOTS];
+static uint16_t counts[PSAMP_SLOTS];
+static uint32_t last_cycles; // mcycle at the last sample, wraps in 40 s
+static PsampStats stats;
+
+/**
+ * Sample the interrupted PC into an open-addressed histogram.
+ * */
+void TIMER1_IRQHandler(void) {
+  uint32_t t0 = prof_cycles();
+  uint32_t pc = read_csr(mepc);
+  uint32_t slot = (pc >> 1) * 2654435761u >> (32 - __builtin_ctz(PSAMP_SLOTS));
+
+  timer_interrupt_flag_clear(TIMER1, TIMER_INT_FLAG_UP);
+
+  stats.samples++;
+  for (int probe = 0;; ++probe, slot = (slot + 1) & SLOT_MASK) {
+    if (probe == MAX_PROBE) {
+      stats.dropped++;
+      break;
+    }
+    if (counts[slot] == 0)
+      pcs[slot] = pc;
+    if (pcs[slot] == pc) {
+      if (counts[slot] != UINT16_MAX)
+        counts[slot]++;
+      break;
+    }
+  }
+
+  // Both sums are taken per sample, well inside one wrap of mcycle
+  stats.isr_cycles += prof_cycles() - t0;
+  stats.span_cycles += t0 - last_cycles;
+  last_cycles = t0;
+}
+
+/**
+ * Start sampling on TIMER1.
+ * @param[in] hz sample rate, clamped to PSAMP_MIN_HZ..PSAMP_MAX_HZ
+ * */
+void Psamp_Start(uint32_t hz) {
+  timer_parameter_struct timer_initpara;
+
+  if (hz < PSAMP_MIN_HZ)
+    hz = PSAMP_MIN_HZ;
+  if (hz > PSAMP_MAX_HZ)
+    hz = PSAMP_MAX_HZ;
+  stats.hz = hz;
+
+  rcu_periph_clock_enable(RCU_TIMER1);
+  timer_deinit(TIMER1);
+  // 1 MHz counter clock, TIMER1 runs at SystemCoreClock with APB1 = AHB/2
+  timer_initpara.prescaler = SystemCoreClock / 1000000 - 1;
+  timer_initpara.period = 1000000 / hz - 1;
+  timer_initpara.alignedmode = TIMER_COUNTER_EDGE;
+  timer_initpara.counterdirection = TIMER_COUNTER_UP;
+  timer_initpara.clockdivision = TIMER_CKDIV_DIV1;
+  timer_initpara.repetitioncounter = 0;
+  timer_init(TIMER1, &timer_initpara);
+
+  timer_interrupt_flag_clear(TIMER1, TIMER_INT_FLAG_UP);
+  timer_interrupt_enable(TIMER1, TIMER_INT_UP);
+  eclic_irq_enable(TIMER1_IRQn, 1, 1);
+
+  last_cycles = prof_cycles();
+  timer_enable(TIMER1);
+}
+
+void Psamp_Stop(void) {
+  timer_disable(TIMER1);
+  eclic_irq_disable(TIMER1_IRQn);
+}
+
+void Psamp_Reset(void) {
+  for (int i = 0; i < PSAMP_SLOTS; ++i)
+    counts[i] = 0;
+  stats.samples = stats.dropped = 0;
+  stats.isr_cycles = stats.span_cycles = 0;
+  last_cycles = prof_cycles();
+}
+
+const PsampStats *Psamp_Stats(void) {
+  if (stats.span_cycles)
+    stats.overhead_ppm =
+        (uint32_t)(stats.isr_cycles * 1000000 / stats.span_cycles);
+  return &stats;
+}
+
+/**
+ * Write the histogram to USART0 as "pc count" lines between PSAMP markers,
+ * ready to be matched against riscv-nuclei-elf-objdump output on the host.
+ * */
+void Psamp_Dump(void) {
+  const PsampStats *s = Psamp_Stats();
+
+  Serial_Write("PSAMP BEGIN hz=");
+  Serial_WriteDec(s->hz);
+  Serial_Write(" samples=");
+  Serial_WriteDec(s->samples);
+  Serial_Write(" dropped=");
+  Serial_WriteDec(s->dropped);
+  Serial_Write(" isr_kcycles="); // 64-bit sum, in thousands to fit
+  Serial_WriteDec((uint32_t)(s->isr_cycles / 1000));
+  Serial_Write(" overhead_ppm=");
+  Serial_WriteDec(s->overhead_ppm);
+  Serial_Write("\r\n");
+  for (int i = 0; i < PSAMP_SLOTS; ++i) {
+    if (counts[i] == 0)
+      continue;
+    Serial_WriteHex(pcs[i]);
+    Serial_PutChar(' ');
+    Serial_WriteDec(counts[i]);
+    Serial_Write("\r\n");
+  }
+  Serial_Write("PSAMP END\r\n");
+}
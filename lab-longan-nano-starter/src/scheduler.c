@@ -0,0 +1,99 @@
+#include "scheduler.h"
+#include "gd32vf103_libopt.h"
+#include "riscv_encoding.h"
+#include "tick.h"
+
+static uint32_t tick_period; // mtime ticks per logic tick
+static uint32_t accumulator; // mtime ticks not yet consumed by logic
+static uint64_t last_poll;
+static uint64_t last_frame;
+static uint32_t idle_time;
+static SchedStats stats;
+
+/**
+ * Start the logic clock. Call once after the peripherals are up.
+ * */
+void Sched_Init(void) {
+  tick_period = SystemCoreClock / 4 / SCHED_LOGIC_HZ;
+  accumulator = 0;
+  last_poll = last_frame = get_timer_value();
+
+  Tick_Init(); // wakes Sched_Idle
+}
+
+/**
+ * Advance the logic clock to now.
+ * @returns number of logic ticks the caller must run before rendering,
+ *          at most SCHED_MAX_CATCHUP; 0 means nothing is due yet
+ * */
+int Sched_Poll(void) {
+  uint64_t now = get_timer_value();
+  uint64_t elapsed = now - last_poll;
+  uint32_t limit = tick_period * (SCHED_MAX_CATCHUP + 1);
+  int ticks;
+
+  last_poll = now;
+  // Clamp before narrowing, a long stall would otherwise overflow. The
+  // ticks cut off here are dropped as much as those over the catch-up limit.
+  if (elapsed > limit) {
+    stats.dropped_ticks += (uint32_t)((elapsed - limit) / tick_period);
+    elapsed = limit;
+  }
+  accumulator += (uint32_t)elapsed;
+
+  ticks = accumulator / tick_period;
+  accumulator -= ticks * tick_period;
+  if (ticks > SCHED_MAX_CATCHUP) {
+    stats.dropped_ticks += ticks - SCHED_MAX_CATCHUP;
+    ticks = SCHED_MAX_CATCHUP;
+  }
+  stats.logic_ticks += ticks;
+  stats.last_catchup = ticks;
+  return ticks;
+}
+
+/**
+ * Sleep in WFI until the next interrupt, at the latest the next 1 kHz
+ * tick. Logic time is still counted in mtime, so waking up to a
+ * millisecond past the deadline adds jitter but no drift.
+ * */
+void Sched_Idle(void) {
+  uint64_t start = get_timer_value();
+  uint64_t deadline = last_poll + (tick_period - accumulator);
+
+  // Interrupts stay masked until after WFI so the wake-up cannot be lost
+  clear_csr(mstatus, MSTATUS_MIE);
+  if (get_timer_value() < deadline)
+    __asm__ volatile("wfi");
+  set_csr(mstatus, MSTATUS_MIE);
+
+  idle_time += (uint32_t)(get_timer_value() - start);
+}
+
+/**
+ * @returns mtime ticks until the next logic tick is due, 0 if it already is
+ * */
+uint32_t Sched_TimeLeft(void) {
+  uint64_t since = get_timer_value() - last_poll;
+  uint32_t left = tick_period - accumulator;
+
+  return since >= left ? 0 : left - (uint32_t)since;
+}
+
+/**
+ * Mark the end of a rendered frame.
+ * */
+void Sched_FrameDone(void) {
+  uint64_t now = get_timer_value();
+
+  stats.frames++;
+  stats.last_frame_time = (uint32_t)(now - last_frame);
+  stats.last_idle_time = idle_time;
+  last_frame = now;
+  idle_time = 0;
+}
+
+/**
+ * @returns frame timing statistics for the HUD
+ * */
+const SchedStats *Sched_Stats(void) { return &stats; }
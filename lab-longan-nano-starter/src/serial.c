@@ -0,0 +1,59 @@
+#include "serial.h"
+#include "fmt.h"
+#include "gd32vf103_libopt.h"
+
+/**
+ * USART0 on PA9 (TX) / PA10 (RX), 8N1, blocking transmit.
+ * */
+void Serial_Init(void) {
+  rcu_periph_clock_enable(RCU_GPIOA);
+  rcu_periph_clock_enable(RCU_USART0);
+
+  gpio_init(GPIOA, GPIO_MODE_AF_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_9);
+  gpio_init(GPIOA, GPIO_MODE_IN_FLOATING, GPIO_OSPEED_50MHZ, GPIO_PIN_10);
+
+  usart_deinit(USART0);
+  usart_baudrate_set(USART0, SERIAL_BAUDRATE);
+  usart_word_length_set(USART0, USART_WL_8BIT);
+  usart_stop_bit_set(USART0, USART_STB_1BIT);
+  usart_parity_config(USART0, USART_PM_NONE);
+  usart_receive_config(USART0, USART_RECEIVE_ENABLE);
+  usart_transmit_config(USART0, USART_TRANSMIT_ENABLE);
+  usart_enable(USART0);
+}
+
+void Serial_PutChar(char c) {
+  while (RESET == usart_flag_get(USART0, USART_FLAG_TBE))
+    ;
+  usart_data_transmit(USART0, (uint8_t)c);
+}
+
+void Serial_Write(const char *s) {
+  while (*s)
+    Serial_PutChar(*s++);
+}
+
+/**
+ * @param[in] v printed as 8 hex digits with a 0x prefix
+ * */
+void Serial_WriteHex(uint32_t v) {
+  char buf[9];
+  Serial_Write("0x");
+  Fmt_Hex(buf, v, 8);
+  Serial_Write(buf);
+}
+
+void Serial_WriteDec(uint32_t v) {
+  char buf[11];
+  Fmt_Udec(buf, v, 1, ' ');
+  Serial_Write(buf);
+}
+
+/**
+ * @returns the next received byte, or -1 if none is waiting
+ * */
+int Serial_GetChar(void) {
+  if (RESET == usart_flag_get(USART0, USART_FLAG_RBNE))
+    return -1;
+  return usart_data_receive(USART0) & 0xFF;
+}
@@ -34,6 +34,7 @@ OF SUCH DAMAGE.
 
 #include "gd32vf103.h"
 #include "systick.h"
+#include "tick.h"
 
 /*!
     \brief      delay a time in milliseconds
@@ -43,15 +44,12 @@ OF SUCH DAMAGE.
 */
 void delay_1ms(uint32_t count)
 {
-	uint64_t start_mtime, delta_mtime;
-
-	// Don't start measuruing until we see an mtime tick
-	uint64_t tmp = get_timer_value();
-	do {
-	start_mtime = get_timer_value();
-	} while (start_mtime == tmp);
-
-	do {
-	delta_mtime = get_timer_value() - start_mtime;
-	}while(delta_mtime <(SystemCoreClock/4000.0 *count ));
+	uint32_t start;
+
+	Tick_Init();
+	start = Tick_Ms();
+	// The next tick may be almost due, so wait for count + 1 of them
+	while (Tick_Ms() - start <= count) {
+		__asm__ volatile("wfi");
+	}
 }
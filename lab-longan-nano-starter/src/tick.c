@@ -0,0 +1,71 @@
+#include "tick.h"
+#include "gd32vf103_libopt.h"
+
+static volatile uint32_t ms; // ticks since Tick_Init, wraps after 49 days
+static TickHook hooks[TICK_MAX_HOOKS];
+static int hook_count;
+static int started;
+
+/**
+ * Count the millisecond and run the hooks. Everything registered here
+ * must be short: it delays every interrupt at the same level.
+ * */
+void TIMER2_IRQHandler(void) {
+  timer_interrupt_flag_clear(TIMER2, TIMER_INT_FLAG_UP);
+  ms++;
+  int n = __atomic_load_n(&hook_count, __ATOMIC_ACQUIRE);
+  for (int i = 0; i < n; ++i)
+    hooks[i]();
+}
+
+/**
+ * Start the tick and enable interrupts. Safe to call more than once, the
+ * first delay_1ms does it if nobody has yet.
+ * */
+void Tick_Init(void) {
+  timer_parameter_struct timer_initpara;
+
+  if (started)
+    return;
+  started = 1;
+
+  rcu_periph_clock_enable(RCU_TIMER2);
+  timer_deinit(TIMER2);
+  // 1 MHz counter clock, TIMER2 runs at SystemCoreClock with APB1 = AHB/2
+  timer_initpara.prescaler = SystemCoreClock / 1000000 - 1;
+  timer_initpara.period = 1000000 / TICK_HZ - 1;
+  timer_initpara.alignedmode = TIMER_COUNTER_EDGE;
+  timer_initpara.counterdirection = TIMER_COUNTER_UP;
+  timer_initpara.clockdivision = TIMER_CKDIV_DIV1;
+  timer_initpara.repetitioncounter = 0;
+  timer_init(TIMER2, &timer_initpara);
+
+  timer_interrupt_flag_clear(TIMER2, TIMER_INT_FLAG_UP);
+  timer_interrupt_enable(TIMER2, TIMER_INT_UP);
+  eclic_priority_group_set(ECLIC_PRIGROUP_LEVEL3_PRIO1);
+  eclic_irq_enable(TIMER2_IRQn, 2, 1);
+  eclic_global_interrupt_enable();
+  timer_enable(TIMER2);
+}
+
+/**
+ * @returns milliseconds since Tick_Init
+ * */
+uint32_t Tick_Ms(void) { return ms; }
+
+/**
+ * Call hook once per millisecond from the tick interrupt.
+ * @returns 1 if registered or already registered, 0 if the table is full
+ * */
+int Tick_Register(TickHook hook) {
+  for (int i = 0; i < hook_count; ++i) {
+    if (hooks[i] == hook)
+      return 1;
+  }
+  if (hook_count == TICK_MAX_HOOKS)
+    return 0;
+  hooks[hook_count] = hook;
+  // publish after the slot is written, the ISR may be running
+  __atomic_store_n(&hook_count, hook_count + 1, __ATOMIC_RELEASE);
+  return 1;
+}
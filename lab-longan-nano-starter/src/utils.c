@@ -12,6 +12,31 @@ int Get_Button(int ch)
     return (int)(gpio_input_bit_get(io_periph[ch], io_pin[ch]));
 }
 
+uint8_t input_held, input_pressed, input_released;
+
+/**
+ * Read GPIOA and GPIOC once and update the edge masks against the
+ * previous call.
+ * @returns bit n set while button n of the utils.h enumeration is held
+ * */
+uint32_t Input_Snapshot(void)
+{
+    uint32_t pa = GPIO_ISTAT(GPIOA);
+    uint32_t pc = GPIO_ISTAT(GPIOC);
+    uint8_t prev = input_held;
+
+    // PA1..PA3 are JOY_LEFT, JOY_DOWN, JOY_RIGHT; PA0 is JOY_CTR
+    // PC13 is JOY_UP, PC15 is BUTTON_1, PC14 is BUTTON_2
+    input_held = ((pa >> 1) & 0x7)
+               | ((pa & GPIO_PIN_0) << JOY_CTR)
+               | (((pc >> 13) & 1) << JOY_UP)
+               | (((pc >> 15) & 1) << BUTTON_1)
+               | (((pc >> 14) & 1) << BUTTON_2);
+    input_pressed = input_held & ~prev;
+    input_released = prev & ~input_held;
+    return input_held;
+}
+
 /**
  * @returns 1 if button BOOT0 ch is pressed, 0 otherwise
  * */
@@ -0,0 +1,272 @@
+#include "video.h"
+#include <stddef.h>
+#include <string.h>
+#include "fatfs/diskio.h"
+#include "lcd/pixels.h"
+#include "profiler.h"
+#include "systick.h"
+#include "tick.h"
+
+// The clip is opened like the asset pack: in one piece it is read as raw
+// sectors, VIDEO_BUF_SECTORS per disk_read, into two buffers taken in turn.
+// While one is read from the card the other is still going out to the LCD
+// by DMA, so a key frame costs about the longer of the two transfers rather
+// than their sum.
+//
+// A delta frame is a list of spans, each a 4-byte header {x, y, n, op}
+// followed by its pixels: n of them for SPAN_LIT, one to repeat n times for
+// SPAN_RUN. A span opens the window x..width-1 on row y, or with SPAN_CONT
+// set goes on where the previous one stopped, which saves the address
+// commands between the pieces of one changed stretch. Spans never straddle
+// a sector and n == 0 ends one, so the encoder's zero fill needs no marker.
+#define SPAN_LIT 0
+#define SPAN_RUN 1
+#define SPAN_CONT 0x80
+
+#define PER_INDEX (VIDEO_SECTOR / sizeof(VideoFrame))
+#define NO_SECTOR 0xFFFFFFFFu
+
+static DWORD clmt[VIDEO_CLMT_ITEMS];
+static FIL *clip;              // NULL while closed
+static uint8_t *index_buf;     // one sector of the header or the index
+static uint32_t index_sector;  // clip sector held in index_buf
+static uint8_t *half[2];       // ping-pong buffers
+static int dma_half;           // buffer the LCD DMA may still read, -1 if none
+static uint32_t start;         // LBA of the clip, 0 if reads go through FatFs
+static VideoHeader head;
+static VideoStats *stats;      // while playing
+
+// Whole sectors of the clip, sector counted from its start
+static int read_sectors(uint32_t sector, void *buf, uint32_t n) {
+  uint32_t t = prof_cycles();
+  UINT br;
+  int ok;
+
+  if (start)
+    ok = disk_read(0, buf, start + sector, n) == RES_OK;
+  else
+    ok = f_read_at(clip, (FSIZE_t)sector * VIDEO_SECTOR, buf,
+                   n * VIDEO_SECTOR, &br) == FR_OK &&
+         br == n * VIDEO_SECTOR;
+  if (stats) {
+    stats->read_cycles += prof_cycles() - t;
+    stats->sectors += n;
+  }
+  return ok;
+}
+
+static int frame_entry(uint32_t k, VideoFrame *f) {
+  uint32_t sector = head.index_sector + k / PER_INDEX;
+
+  if (index_sector != sector) {
+    index_sector = NO_SECTOR;
+    if (!read_sectors(sector, index_buf, 1))
+      return 0;
+    index_sector = sector;
+  }
+  memcpy(f, index_buf + k % PER_INDEX * sizeof *f, sizeof *f);
+  return 1;
+}
+
+static void lcd_wait(void) {
+  uint32_t t = prof_cycles();
+
+  LCD_PixelsWait();
+  stats->wait_cycles += prof_cycles() - t;
+  dma_half = -1;
+}
+
+static void lcd_end(void) {
+  lcd_wait();
+  LCD_PixelsEnd();
+}
+
+// Next chunk of a frame into buffer h, once the LCD is done with it
+static int read_chunk(int h, uint32_t sector, uint32_t n) {
+  if (dma_half == h)
+    lcd_wait();
+  return read_sectors(sector, half[h], n);
+}
+
+static uint32_t chunk_sectors(const VideoFrame *f, uint32_t done) {
+  uint32_t n = f->sectors - done;
+  return n < VIDEO_BUF_SECTORS ? n : VIDEO_BUF_SECTORS;
+}
+
+static int play_key(const VideoFrame *f) {
+  uint32_t left = (uint32_t)head.width * head.height * 2;
+  int h = 0;
+
+  LCD_PixelsBegin(0, 0, head.width - 1, head.height - 1);
+  for (uint32_t s = 0, n; s < f->sectors && left; s += n, h ^= 1) {
+    n = chunk_sectors(f, s);
+    if (!read_chunk(h, f->sector + s, n))
+      break;
+    uint32_t len = n * VIDEO_SECTOR < left ? n * VIDEO_SECTOR : left;
+    lcd_wait();
+    LCD_PixelsWrite(half[h], len);
+    dma_half = h;
+    left -= len;
+  }
+  lcd_end();
+  return left == 0;
+}
+
+// The spans of one sector, @returns 0 if they do not fit the clip
+static int play_spans(int h, const uint8_t *p, int *open) {
+  const uint8_t *end = p + VIDEO_SECTOR;
+
+  while (end - p >= 4 && p[2]) {
+    uint32_t x = p[0], y = p[1], n = p[2], kind = p[3] & ~SPAN_CONT;
+    uint32_t size = kind == SPAN_RUN ? 2 : 2 * n;
+    int cont = p[3] & SPAN_CONT;
+    p += 4;
+    if (size > (uint32_t)(end - p) || kind > SPAN_RUN)
+      return 0;
+    if (!cont) {
+      if (x + n > head.width || y >= head.height)
+        return 0;
+      if (*open)
+        lcd_end();
+      LCD_PixelsBegin(x, y, head.width - 1, y);
+      *open = 1;
+    } else if (!*open) {
+      return 0;
+    }
+    lcd_wait();
+    if (kind == SPAN_RUN) {
+      LCD_PixelsFill(p[0] << 8 | p[1], n);
+    } else {
+      LCD_PixelsWrite(p, size);
+      dma_half = h;
+    }
+    p += size;
+  }
+  return 1;
+}
+
+static int play_delta(const VideoFrame *f) {
+  int h = 0, open = 0, ok = 1;
+
+  for (uint32_t s = 0, n; ok && s < f->sectors; s += n, h ^= 1) {
+    n = chunk_sectors(f, s);
+    ok = read_chunk(h, f->sector + s, n);
+    for (uint32_t i = 0; ok && i < n; ++i)
+      ok = play_spans(h, half[h] + i * VIDEO_SECTOR, &open);
+  }
+  if (open)
+    lcd_end();
+  return ok;
+}
+
+// Newest key frame in (k, due], k itself if there is none to skip to
+static uint32_t catch_up(uint32_t k, uint32_t due) {
+  VideoFrame f;
+
+  if (due >= head.frames)
+    due = head.frames - 1;
+  for (uint32_t j = due; j > k; --j) {
+    if (!frame_entry(j, &f))
+      break;
+    if (f.type == VIDEO_KEY)
+      return j;
+  }
+  return k;
+}
+
+/**
+ * @param[in] fp file object, @param[in] mem VIDEO_MEM bytes of buffers;
+ * both stay in use until Video_Close
+ * @returns 1 if path is a clip of this version
+ * */
+int Video_Open(FIL *fp, const char *path, uint8_t *mem) {
+  FRESULT res = f_fastseek_open(fp, path, clmt, VIDEO_CLMT_ITEMS);
+
+  clip = NULL;
+  stats = NULL;
+  if (res != FR_OK && res != FR_NOT_ENOUGH_CORE)
+    return 0;
+  clip = fp;
+  index_buf = mem;
+  half[0] = mem + VIDEO_SECTOR;
+  half[1] = half[0] + VIDEO_BUF_SECTORS * VIDEO_SECTOR;
+  dma_half = -1;
+  start = f_start_sector(fp);
+  index_sector = NO_SECTOR;
+  if (!read_sectors(0, index_buf, 1)) {
+    Video_Close();
+    return 0;
+  }
+  index_sector = 0;
+  memcpy(&head, index_buf, sizeof head);
+  if (head.magic != VIDEO_MAGIC || head.version != VIDEO_VERSION ||
+      head.frame_size != sizeof(VideoFrame) || !head.fps ||
+      !head.frames || !head.width || head.width > 256 || !head.height ||
+      head.height > 256 ||
+      (FSIZE_t)head.sectors * VIDEO_SECTOR > f_size(fp)) {
+    Video_Close();
+    return 0;
+  }
+  return 1;
+}
+
+const VideoHeader *Video_Header(void) { return clip ? &head : NULL; }
+
+/**
+ * Play the open clip to the end at its frame rate. A frame is sent when
+ * it is due; once a whole frame behind, the player skips to the newest
+ * key frame already due, delta frames in between cannot be left out.
+ * @param[in] skip polled before every frame, may be NULL
+ * @returns 1 if the clip played to its end
+ * */
+int Video_Play(VideoSkip skip, VideoStats *st) {
+  uint32_t t0 = Tick_Ms(), c = prof_cycles(), k = 0;
+  VideoFrame f;
+
+  memset(st, 0, sizeof *st);
+  if (!clip)
+    return 0;
+  stats = st;
+  st->frames = head.frames;
+  while (k < head.frames && !(skip && skip())) {
+    uint32_t now = Tick_Ms() - t0;
+    uint32_t due = (uint32_t)((uint64_t)now * head.fps / 1000);
+    if (due > k) {
+      uint32_t j = catch_up(k, due);
+      st->dropped += j - k;
+      k = j;
+      if (due > k)
+        st->late++;
+    } else {
+      uint32_t at = (uint32_t)((uint64_t)k * 1000 / head.fps);
+      uint32_t t = prof_cycles();
+      while (Tick_Ms() - t0 < at)
+        delay_1ms(0); // the next tick
+      st->idle_cycles += prof_cycles() - t;
+    }
+    if (!frame_entry(k, &f) || f.sector + f.sectors > head.sectors ||
+        !(f.type == VIDEO_KEY ? play_key(&f) : play_delta(&f)))
+      break;
+    st->shown++;
+    st->keys += f.type == VIDEO_KEY;
+    st->last = k++;
+    uint32_t t = prof_cycles(); // counted per frame, mcycle wraps in 40 s
+    st->cycles += t - c;
+    c = t;
+  }
+  st->ms = Tick_Ms() - t0;
+  stats = NULL;
+  return k == head.frames;
+}
+
+/**
+ * @returns LBA of the clip on the card, 0 if it is read through FatFs
+ * */
+uint32_t Video_StartSector(void) { return clip ? start : 0; }
+
+void Video_Close(void) {
+  if (clip)
+    f_close(clip);
+  clip = NULL;
+  stats = NULL;
+}
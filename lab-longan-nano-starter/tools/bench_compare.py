@@ -0,0 +1,46 @@
+#!/usr/bin/env python3
+"""Compare busy cycles per frame between two benchmark captures.
+
+Usage: bench_compare.py BASELINE.txt CANDIDATE.txt
+
+Both files are USART0 logs of firmware built with -D BENCHMARK_FRAMES=<n>,
+e.g. the bench-flash and bench-ram environments in platformio.ini.
+"""
+import sys
+
+
+def read_bench(path):
+    bench = ftime = None
+    with open(path, errors="replace") as f:
+        for line in f:
+            if line.startswith("BENCH "):
+                bench = dict(kv.split("=") for kv in line.split()[1:])
+            elif line.startswith("FTIME BEGIN"):
+                ftime = dict(kv.split("=") for kv in line.split()[2:])
+    if bench is None or ftime is None:
+        sys.exit("no BENCH/FTIME dump in %s" % path)
+    return bench, ftime
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+
+    runs = [read_bench(path) for path in sys.argv[1:3]]
+    print("%-12s %8s %8s %8s %16s %8s" %
+          ("run", "ramfunc", "bullets", "frames", "cycles_per_frame",
+           "p99_us"))
+    for path, (bench, ftime) in zip(sys.argv[1:3], runs):
+        print("%-12s %8s %8s %8s %16s %8s" %
+              (path[-12:], bench["ramfunc"], bench["bullets"],
+               bench["frames"], bench["cycles_per_frame"], ftime["p99_us"]))
+
+    if runs[0][0]["bullets"] != runs[1][0]["bullets"]:
+        print("warning: the runs had different storm sizes")
+    base = int(runs[0][0]["cycles_per_frame"])
+    cand = int(runs[1][0]["cycles_per_frame"])
+    print("cycles per frame %+.1f%%" % (100.0 * (cand - base) / base))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,127 @@
+// Replay recorded button edges through src/debounce.c on the host.
+//
+// Build:  cc -O2 -Iinclude -o debounce_replay tools/debounce_replay.c
+//             src/debounce.c
+// Usage:  debounce_replay [-d MS] TRACE...
+//
+// A trace has one line per raw edge, "edge US KEY LEVEL", in time order as
+// the EXTI handlers would see them, with KEY numbered as in include/utils.h
+// (JOY_LEFT 0 .. BUTTON_2 6) and LEVEL 1 for pressed. Lines "expect US KEY
+// LEVEL" give the events the game should get; '#' starts a comment. The
+// edges go to Debounce_Edge with the stamp as is, and Debounce_Settle runs
+// on every millisecond as the 1 kHz tick runs Input_Settle. Each event is
+// printed; the exit status is nonzero if they differ from the expected
+// ones. -d sets the lock, default INPUT_DEBOUNCE_MS. tools/traces holds
+// presses with contact bounce of the kind a logic analyser shows on PA0-3.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "debounce.h"
+
+#define KEYS 7
+#define MAX_EVENTS 256
+#ifndef INPUT_DEBOUNCE_MS
+#define INPUT_DEBOUNCE_MS 20 // as in include/input.h, which needs the SDK
+#endif
+
+typedef struct {
+  uint32_t us;
+  unsigned key, level;
+} Event;
+
+static DebounceKey keys[KEYS];
+static Event got[MAX_EVENTS], want[MAX_EVENTS];
+static int ngot, nwant;
+static uint32_t dt_us = INPUT_DEBOUNCE_MS * 1000u;
+static uint32_t ticked_ms; // last millisecond Debounce_Settle ran for
+
+static void report(uint32_t us, unsigned key, unsigned level) {
+  printf("%10u us  key %u %s\n", us, key, level ? "pressed" : "released");
+  if (ngot < MAX_EVENTS)
+    got[ngot++] = (Event){us, key, level};
+}
+
+// The tick hook for every millisecond up to and including now
+static void tick_to(uint32_t now) {
+  for (; ticked_ms < now / 1000; ++ticked_ms) {
+    uint32_t t = (ticked_ms + 1) * 1000;
+    for (unsigned k = 0; k < KEYS; ++k)
+      if (Debounce_Settle(&keys[k], t, dt_us))
+        report(t, k, keys[k].level);
+  }
+}
+
+static int replay(const char *path) {
+  char line[128], what[16];
+  unsigned long us;
+  unsigned key, level;
+  int n = 0, bad = 0;
+  FILE *f = fopen(path, "r");
+
+  if (!f) {
+    perror(path);
+    return 1;
+  }
+  memset(keys, 0, sizeof keys);
+  ngot = nwant = 0;
+  ticked_ms = 0;
+  printf("%s:\n", path);
+  while (fgets(line, sizeof line, f)) {
+    ++n;
+    char *hash = strchr(line, '#');
+    if (hash)
+      *hash = '\0';
+    if (strspn(line, " \t\r\n") == strlen(line))
+      continue;
+    if (sscanf(line, "%15s %lu %u %u", what, &us, &key, &level) != 4 ||
+        key >= KEYS || level > 1) {
+      fprintf(stderr, "%s:%d: bad line\n", path, n);
+      fclose(f);
+      return 1;
+    }
+    if (!strcmp(what, "edge")) {
+      tick_to((uint32_t)us);
+      if (Debounce_Edge(&keys[key], (uint8_t)level, (uint32_t)us, dt_us))
+        report((uint32_t)us, key, level);
+    } else if (!strcmp(what, "expect") && nwant < MAX_EVENTS) {
+      want[nwant++] = (Event){(uint32_t)us, key, level};
+    }
+  }
+  fclose(f);
+  tick_to(ticked_ms * 1000 + 2 * dt_us); // let the last locks run out
+
+  for (int i = 0; i < ngot || i < nwant; ++i) {
+    if (i < ngot && i < nwant && !memcmp(&got[i], &want[i], sizeof got[i]))
+      continue;
+    if (i < nwant)
+      fprintf(stderr, "  expected %u us key %u level %u\n", want[i].us,
+              want[i].key, want[i].level);
+    else
+      fprintf(stderr, "  unexpected event %d\n", i);
+    bad = 1;
+    break;
+  }
+  printf("  %d events, %s\n", ngot, bad ? "MISMATCH" : "as expected");
+  return bad;
+}
+
+int main(int argc, char **argv) {
+  int opt, bad = 0;
+
+  while ((opt = getopt(argc, argv, "d:")) != -1) {
+    if (opt != 'd') {
+      optind = argc + 1;
+      break;
+    }
+    dt_us = (uint32_t)strtoul(optarg, NULL, 10) * 1000;
+  }
+  if (optind >= argc) {
+    fprintf(stderr, "usage: debounce_replay [-d MS] TRACE...\n");
+    return 2;
+  }
+  for (int i = optind; i < argc; ++i)
+    bad |= replay(argv[i]);
+  return bad;
+}
@@ -0,0 +1,144 @@
+// Replay a disk_read trace through src/fatfs/diskcache.c on the host.
+//
+// Build:  cc -O2 -Iinclude -Iinclude/fatfs -o disksim tools/disksim.c src/fatfs/diskcache.c
+// Usage:  disksim [-p first:count] IMAGE|- TRACE WAYS...
+//
+// TRACE is a USART0 capture from a firmware built with -DSD_CACHE_TRACE=1;
+// every "DT sector count" line is one disk_read call, anything else is
+// skipped. IMAGE is a raw dump of the card (dd if=/dev/sdX) that backs
+// mmc_disk_read, or - for a card of zeros when only the counters matter.
+// Each WAYS value replays the whole trace with a fresh cache, 0 gives the
+// uncached baseline. -p pins a sector range as disk_cache_pin() does,
+// normally the fatbase and fsize of the mounted volume.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fatfs/diskcache.h"
+
+typedef struct {
+  DWORD sector;
+  UINT count;
+} Access;
+
+static FILE *image;       // NULL reads zeros
+static DWORD dev_reads;   // mmc_disk_read calls, one card command each
+static DWORD dev_sectors; // sectors those calls moved
+
+DRESULT mmc_disk_read(BYTE drv, BYTE *buff, DWORD sector, UINT count) {
+  if (drv || !count)
+    return RES_PARERR;
+  dev_reads++;
+  dev_sectors += count;
+  if (!image) {
+    memset(buff, 0, (size_t)count * FF_MAX_SS);
+    return RES_OK;
+  }
+  if (fseek(image, (long)sector * FF_MAX_SS, SEEK_SET) != 0 ||
+      fread(buff, FF_MAX_SS, count, image) != count)
+    return RES_ERROR;
+  return RES_OK;
+}
+
+#if FF_FS_READONLY == 0
+DRESULT mmc_disk_write(BYTE drv, const BYTE *buff, DWORD sector,
+                       UINT count) {
+  (void)buff;
+  (void)sector;
+  if (drv || !count)
+    return RES_PARERR;
+  dev_sectors += count; // the image is never modified
+  return RES_OK;
+}
+#endif
+
+static Access *load_trace(const char *path, size_t *n) {
+  FILE *f = fopen(path, "r");
+  Access *trace = NULL;
+  size_t cap = 0;
+  char line[128];
+  unsigned long sector, count;
+
+  if (!f)
+    return NULL;
+  *n = 0;
+  while (fgets(line, sizeof line, f)) {
+    if (sscanf(line, "DT %lu %lu", &sector, &count) != 2 || !count)
+      continue;
+    if (*n == cap) {
+      cap = cap ? cap * 2 : 1024;
+      trace = realloc(trace, cap * sizeof *trace);
+      if (!trace)
+        break;
+    }
+    trace[*n].sector = (DWORD)sector;
+    trace[*n].count = (UINT)count;
+    ++*n;
+  }
+  fclose(f);
+  return trace;
+}
+
+int main(int argc, char **argv) {
+  unsigned long pin_first = 0, pin_count = 0;
+  static BYTE buff[128 * FF_MAX_SS];
+  Access *trace;
+  size_t n, i;
+  int arg = 1;
+
+  if (argc > 2 && strcmp(argv[1], "-p") == 0) {
+    if (sscanf(argv[2], "%lu:%lu", &pin_first, &pin_count) != 2) {
+      fprintf(stderr, "bad pin range %s\n", argv[2]);
+      return 2;
+    }
+    arg = 3;
+  }
+  if (argc - arg < 3) {
+    fprintf(stderr,
+            "usage: disksim [-p first:count] IMAGE|- TRACE WAYS...\n");
+    return 2;
+  }
+  if (strcmp(argv[arg], "-") != 0 && !(image = fopen(argv[arg], "rb"))) {
+    perror(argv[arg]);
+    return 1;
+  }
+  trace = load_trace(argv[arg + 1], &n);
+  if (!trace || !n) {
+    fprintf(stderr, "no DT lines in %s\n", argv[arg + 1]);
+    return 1;
+  }
+
+  printf("%5s %8s %8s %8s %8s %6s %9s %9s\n", "ways", "hits", "misses",
+         "bypass", "evict", "hit%", "card_cmds", "card_secs");
+  for (int a = arg + 2; a < argc; ++a) {
+    UINT ways = (UINT)strtoul(argv[a], NULL, 10);
+    void *mem = ways ? malloc(ways * DISK_CACHE_LINE) : NULL;
+    const CACHESTATS *cs;
+
+    disk_cache_init(mem, ways * DISK_CACHE_LINE);
+    disk_cache_pin((DWORD)pin_first, (DWORD)pin_count);
+    dev_reads = dev_sectors = 0;
+    for (i = 0; i < n; ++i) {
+      if (trace[i].count > 128 ||
+          disk_read(0, buff, trace[i].sector, trace[i].count) != RES_OK) {
+        fprintf(stderr, "read of %u at %lu failed\n", trace[i].count,
+                (unsigned long)trace[i].sector);
+        return 1;
+      }
+    }
+    cs = disk_cache_stats();
+    printf("%5u %8lu %8lu %8lu %8lu %6.1f %9lu %9lu\n", ways,
+           (unsigned long)cs->hits, (unsigned long)cs->misses,
+           (unsigned long)cs->bypass, (unsigned long)cs->evictions,
+           cs->hits + cs->misses
+               ? 100.0 * cs->hits / (cs->hits + cs->misses)
+               : 0.0,
+           (unsigned long)dev_reads, (unsigned long)dev_sectors);
+    disk_cache_init(NULL, 0);
+    free(mem);
+  }
+  free(trace);
+  if (image)
+    fclose(image);
+  return 0;
+}
@@ -0,0 +1,36 @@
+#!/usr/bin/env python3
+"""Fail a build when the benchmark's p99 frame time is over budget.
+
+Usage: ftime_gate.py CAPTURE.txt [budget_us]
+
+CAPTURE.txt is the USART0 log of a firmware built with
+-D BENCHMARK_FRAMES=<n>. The default budget of 33333 us is the README's
+"minimal FPS above 30" bar.
+"""
+import sys
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    budget = int(sys.argv[2]) if len(sys.argv) > 2 else 33333
+
+    fields = None
+    with open(sys.argv[1], errors="replace") as f:
+        for line in f:
+            if line.startswith("FTIME BEGIN"):
+                fields = dict(kv.split("=") for kv in line.split()[2:])
+    if fields is None:
+        sys.exit("no FTIME dump in %s" % sys.argv[1])
+
+    p99 = int(fields["p99_us"])
+    print("frames=%s p50_us=%s p99_us=%d worst_us=%s budget_us=%d" %
+          (fields["frames"], fields["p50_us"], p99, fields["worst_us"], budget))
+    if p99 > budget:
+        print("FAIL: p99 frame time over budget")
+        sys.exit(1)
+    print("PASS")
+
+
+if __name__ == "__main__":
+    main()
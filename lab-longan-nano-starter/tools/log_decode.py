@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""Decode GAMELOG.BIN, the telemetry log of a -DLOG_ENABLE=1 build.
+
+Usage: log_decode.py GAMELOG.BIN [-v]
+
+Prints the final score, the profiler averages over the whole log and the
+last frame-time histogram; -v lists every record. Record layout is in
+include/logbuf.h: an 8-byte header (type, len, seq, ms) and a payload,
+packed into 512-byte sectors with zero fill after the last record.
+"""
+import struct
+import sys
+
+SECTOR = 512
+HEADER = struct.Struct("<BBHI")
+PAD, SCORE, FTIME, PROF = range(4)
+# ProfPhase order in include/profiler.h
+PHASES = ("logic", "hud", "draw", "erase", "store", "disk", "idle")
+
+
+def records(data):
+    for base in range(0, len(data) - SECTOR + 1, SECTOR):
+        pos = base
+        while pos + HEADER.size <= base + SECTOR:
+            kind, size, seq, ms = HEADER.unpack_from(data, pos)
+            end = pos + HEADER.size + size
+            if kind == PAD or kind > PROF or end > base + SECTOR:
+                break  # rest of the sector is fill
+            words = struct.unpack_from("<%dI" % (size // 4), data,
+                                       pos + HEADER.size)
+            yield kind, seq, ms, words
+            pos = end
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    verbose = "-v" in sys.argv[2:]
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+    if len(data) % SECTOR:
+        print("warning: %d bytes past the last whole sector" %
+              (len(data) % SECTOR))
+    # A preallocated log is zero after the last sector written
+    used = len(data) - len(data) % SECTOR
+    while used and not any(data[used - SECTOR:used]):
+        used -= SECTOR
+    data = data[:used]
+
+    count = [0] * 4
+    lost = 0
+    last_seq = None
+    score = ftime = None
+    prof_sum, prof_n = None, 0
+    for kind, seq, ms, words in records(data):
+        count[kind] += 1
+        # seq restarts at 0 on every boot, anything else is a dropped record
+        if last_seq is not None and seq and seq != (last_seq + 1) & 0xFFFF:
+            lost += (seq - last_seq - 1) & 0xFFFF
+        last_seq = seq
+        if kind == SCORE:
+            score = (ms,) + words
+        elif kind == FTIME:
+            ftime = (ms,) + words
+        elif kind == PROF:
+            cycles = words[1:]
+            prof_sum = [a + b for a, b in zip(prof_sum or [0] * len(cycles),
+                                              cycles)]
+            prof_n += 1
+        if verbose:
+            print("%5d %9d ms %-5s %s" % (seq, ms,
+                                          ("pad", "score", "ftime",
+                                           "prof")[kind],
+                                          " ".join(map(str, words[:8]))))
+
+    print("%d sectors, %d score, %d ftime, %d prof records, %d dropped" %
+          (len(data) // SECTOR, count[SCORE], count[FTIME], count[PROF],
+           lost))
+    if score:
+        print("score at %d ms: frame %d, %d kills, %d enemies alive" % score)
+    if prof_n:
+        print("profiler averages over %d samples (cycles per frame):" %
+              prof_n)
+        for i, total in enumerate(prof_sum):
+            name = PHASES[i] if i < len(PHASES) else "phase%d" % i
+            print("  %-6s %10d" % (name, total // prof_n))
+    if ftime:
+        ms, frames, p50, p99, worst = ftime[:5]
+        print("frame time at %d ms over %d frames: p50 %d us, p99 %d us, "
+              "worst %d us" % (ms, frames, p50, p99, worst))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,103 @@
+// Run src/logbuf.c on the host with a plain file in place of the card.
+//
+// Build:  cc -O2 -DHOST_BUILD -Iinclude -o logsim tools/logsim.c src/logbuf.c
+// Usage:  logsim OUT.BIN [FRAMES [PAUSE_EVERY]]
+//
+// Plays FRAMES frames of 60 Hz game time (default 36000, ten minutes)
+// against the record rates of src/main.c: a profiler sample every
+// LOG_PROF_FRAMES, a histogram every LOG_FTIME_FRAMES, a score record per
+// kill and Log_Sync on every pause. Full sectors are flushed whenever
+// Log_Pending, as the idle branch does. OUT.BIN has the layout of
+// GAMELOG.BIN and decodes with tools/log_decode.py. The time spent in
+// Log_Record is printed against the 16.7 ms frame; the flush time is file
+// I/O here and says nothing about the card.
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "logbuf.h"
+
+#define FRAME_US 16667
+
+static FILE *out;
+static uint32_t now_ms;
+static uint32_t sink_writes[LOG_BUFFER_SECTORS + 1]; // by sectors per write
+
+uint32_t Tick_Ms(void) { return now_ms; }
+
+int Log_SinkOpen(void) { return out != NULL; }
+
+int Log_SinkWrite(const void *data, uint32_t sectors) {
+  if (sectors <= LOG_BUFFER_SECTORS)
+    sink_writes[sectors]++;
+  return fwrite(data, LOG_SECTOR, sectors, out) == sectors;
+}
+
+int Log_SinkSync(void) { return fflush(out) == 0; }
+
+void Log_SinkClose(void) {
+  fclose(out);
+  out = NULL;
+}
+
+int main(int argc, char **argv) {
+  static uint8_t mem[LOG_BUFFER_SECTORS * LOG_SECTOR];
+  uint32_t frames = 36000, pause_every = 0, kills = 0;
+  const LogStats *ls;
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: logsim OUT.BIN [FRAMES [PAUSE_EVERY]]\n");
+    return 2;
+  }
+  if (argc > 2)
+    frames = (uint32_t)strtoul(argv[2], NULL, 10);
+  if (argc > 3)
+    pause_every = (uint32_t)strtoul(argv[3], NULL, 10);
+  if (!(out = fopen(argv[1], "wb"))) {
+    perror(argv[1]);
+    return 1;
+  }
+  if (!Log_Open(mem, sizeof mem)) {
+    fprintf(stderr, "Log_Open failed\n");
+    return 1;
+  }
+
+  srand(1);
+  for (uint32_t frame = 1; frame <= frames; ++frame) {
+    now_ms = (uint32_t)((uint64_t)frame * FRAME_US / 1000);
+    if (rand() % 40 == 0) { // a kill every two thirds of a second
+      LogScore r = {frame, ++kills, 2};
+      Log_Record(LOG_SCORE, &r, sizeof r);
+    }
+    if (frame % LOG_PROF_FRAMES == 0) {
+      LogProf r = {frame, {0}};
+      for (int p = 0; p < PROF_PHASES; ++p)
+        r.cycles[p] = 100000u * (p + 1) + frame % 977;
+      Log_Record(LOG_PROF, &r, sizeof r);
+    }
+    if (frame % LOG_FTIME_FRAMES == 0 ||
+        (pause_every && frame % pause_every == 0)) {
+      LogFtime r = {frame, 16384, 16384, 20480, {0}};
+      r.bins[27] = frame;
+      Log_Record(LOG_FTIME, &r, sizeof r);
+    }
+    if (pause_every && frame % pause_every == 0)
+      Log_Sync();
+    if (Log_Pending())
+      Log_Flush(LOG_FLUSH_SECTORS); // the idle gap always has room here
+  }
+  Log_Close();
+
+  ls = Log_Stats();
+  printf("frames=%u records=%u dropped=%u sectors=%u writes=%u errors=%u "
+         "syncs=%u\n",
+         frames, ls->records, ls->dropped, ls->sectors, ls->writes,
+         ls->errors, ls->syncs);
+  printf("writes by size:");
+  for (int n = 1; n <= LOG_BUFFER_SECTORS; ++n)
+    printf(" %dx%u", n, sink_writes[n]);
+  printf("\n");
+  printf("Log_Record %u ns total, %.1f ns per frame, %.5f%% of a frame\n",
+         ls->record_cycles, (double)ls->record_cycles / frames,
+         100.0 * ls->record_cycles / frames / (FRAME_US * 1000.0));
+  return ls->dropped || ls->errors;
+}
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""Print the SRAM and flash budget per module.
+
+Usage: mem_report.py firmware.map [CAPTURE.txt]
+
+firmware.map is written by the linker next to firmware.elf (see
+build_flags in platformio.ini). CAPTURE.txt is an optional USART0 log
+holding the reply to the 'm' command; its boot time, stack high-water
+mark, arena usage and pool capacities are appended to the table.
+"""
+import os
+import re
+import sys
+
+RAM_SIZE = 32 * 1024
+CATEGORIES = (
+    ("text", (".text", ".rodata", ".srodata", ".init", ".fini")),
+    ("data", (".data", ".sdata", ".rdata", ".ramfunc")),
+    ("bss", (".bss", ".sbss", "COMMON")),
+)
+# " .bss.foo  0x20000010  0x40 path/to/main.o", the name may sit alone
+# on the line above when it is long
+INPUT = re.compile(r"^ (\S+)?\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$")
+
+
+def category(section):
+    for name, prefixes in CATEGORIES:
+        if section.startswith(prefixes):
+            return name
+    return None
+
+
+def module(path):
+    # libc.a(lib_a-memset.o) stays as is, project objects lose their path
+    return path if "(" in path else os.path.basename(path)
+
+
+def parse_map(path):
+    sizes = {}
+    pending = None
+    in_memory_map = False
+    with open(path, errors="replace") as f:
+        for line in f:
+            if line.startswith("Linker script and memory map"):
+                in_memory_map = True
+                continue
+            if not in_memory_map:
+                continue
+            if re.match(r"^ \S+$", line.rstrip("\n")):
+                pending = line.strip()
+                continue
+            m = INPUT.match(line.rstrip("\n"))
+            section = (m.group(1) if m else None) or pending
+            pending = None
+            if not m or section is None or section == "*fill*":
+                continue
+            kind = category(section)
+            size = int(m.group(3), 16)
+            if kind is None or size == 0:
+                continue
+            row = sizes.setdefault(module(m.group(4)), dict.fromkeys(
+                (c for c, _ in CATEGORIES), 0))
+            row[kind] += size
+    return sizes
+
+
+def parse_capture(path):
+    mem, pools = None, []
+    with open(path, errors="replace") as f:
+        for line in f:
+            if line.startswith("MEM BEGIN"):
+                mem = dict(kv.split("=") for kv in line.split()[2:])
+                pools = []
+            elif line.startswith("POOL ") and mem is not None:
+                parts = line.split()
+                pools.append((parts[1], dict(kv.split("=")
+                                             for kv in parts[2:])))
+    return mem, pools
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+
+    sizes = parse_map(sys.argv[1])
+    if not sizes:
+        sys.exit("no input sections in %s" % sys.argv[1])
+
+    rows = sorted(sizes.items(),
+                  key=lambda kv: (kv[1]["data"] + kv[1]["bss"], kv[1]["text"]),
+                  reverse=True)
+    print("%-32s %8s %8s %8s" % ("module", "text", "data", "bss"))
+    total = dict.fromkeys((c for c, _ in CATEGORIES), 0)
+    for name, row in rows:
+        for c in total:
+            total[c] += row[c]
+        print("%-32s %8d %8d %8d" % (name[-32:], row["text"], row["data"],
+                                      row["bss"]))
+    print("%-32s %8d %8d %8d" % ("total", total["text"], total["data"],
+                                  total["bss"]))
+    static = total["data"] + total["bss"]
+    print("static SRAM %d of %d bytes, %d left for arena and stack" %
+          (static, RAM_SIZE, RAM_SIZE - static))
+
+    if len(sys.argv) < 3:
+        return
+    mem, pools = parse_capture(sys.argv[2])
+    if mem is None:
+        sys.exit("no MEM dump in %s" % sys.argv[2])
+    print()
+    print("boot %s us from reset to main" % mem.get("boot_us", "?"))
+    print("stack %s of %s bytes at the deepest" %
+          (mem["stack_high"], mem["stack"]))
+    print("arena %s of %s bytes in use, %s at the peak" %
+          (mem["arena_used"], mem["arena"], mem["arena_high"]))
+    for name, pool in pools:
+        print("  %-20s cap=%-5s x %3s = %6s bytes" %
+              (name, pool["cap"], pool["elem"], pool["bytes"]))
+    if int(mem["stack_high"]) >= int(mem["stack"]):
+        print("FAIL: stack overflowed into the arena")
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
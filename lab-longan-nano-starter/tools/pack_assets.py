@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""Build an asset pack for src/pack.c.
+
+Usage: pack_assets.py [--raw] [--list] OUT.PAK TYPE/ID=SOURCE...
+
+TYPE is sprite, level, image or font and ID a number below 65536.
+SOURCE is a binary file, or FILE@ARRAY to take the bytes of a C array
+initializer, e.g. image/0=src/lcd/assets.c@logo_bmp. Assets whose size
+is even are stored PACK_RLE16 when that saves at least a sector, unless
+--raw is given. --list prints the index of an existing pack instead.
+
+Copy the pack to the card in one piece (a freshly formatted card, or
+after deleting the old one) so Pack_Open can read it as raw sectors.
+"""
+import os
+import re
+import struct
+import sys
+
+SECTOR = 512
+MAGIC = 0x4B434150
+VERSION = 2
+HEADER = struct.Struct("<IHHIIII")
+ENTRY = struct.Struct("<BBHIIII12s")  # PackEntry in include/pack.h
+TYPES = {"sprite": 1, "level": 2, "image": 3, "font": 4}
+RAW, RLE16 = 0, 1
+MAX_RUN = 0x7FFF
+
+
+def c_array(path, name):
+    with open(path, errors="replace") as f:
+        text = f.read()
+    text = re.sub(r"/\*.*?\*/|//[^\n]*", "", text, flags=re.S)
+    m = re.search(r"\b%s\s*\[[^\]]*\]\s*=\s*\{(.*?)\}" % re.escape(name),
+                  text, re.S)
+    if not m:
+        sys.exit("no array %s in %s" % (name, path))
+    return bytes(int(v, 0) & 0xFF for v in m.group(1).split(",")
+                 if v.strip())
+
+
+def rle16(data):
+    """@returns stored bytes and the slack Pack_Load decodes in place with"""
+    words = struct.unpack("<%dH" % (len(data) // 2), data)
+    out = []
+    lit_at = None
+    slack = 0
+    i = 0
+
+    def close_literal():
+        nonlocal lit_at, slack
+        if lit_at is not None:
+            out[lit_at] = len(out) - lit_at - 1
+            slack = max(slack, 2 * i - 2 * len(out))
+        lit_at = None
+
+    while i < len(words):
+        run = 1
+        while (i + run < len(words) and run < MAX_RUN and
+               words[i + run] == words[i]):
+            run += 1
+        if run >= 3:
+            close_literal()
+            out += [0x8000 | run, words[i]]
+            i += run
+            slack = max(slack, 2 * i - 2 * len(out))
+            continue
+        if lit_at is None or len(out) - lit_at - 1 == MAX_RUN:
+            close_literal()
+            lit_at = len(out)
+            out.append(0)
+        out.append(words[i])
+        i += 1
+    close_literal()
+    return struct.pack("<%dH" % len(out), *out), slack
+
+
+def unrle16(stored, size):
+    words = struct.unpack("<%dH" % (len(stored) // 2), stored)
+    out = []
+    i = 0
+    while i < len(words):
+        n = words[i] & MAX_RUN
+        if words[i] & 0x8000:
+            out += [words[i + 1]] * n
+            i += 2
+        else:
+            out += words[i + 1:i + 1 + n]
+            i += 1 + n
+    data = struct.pack("<%dH" % len(out), *out)
+    return data if len(data) == size else None
+
+
+def sectors(n):
+    return (n + SECTOR - 1) // SECTOR
+
+
+def build(out, specs, allow_rle):
+    assets = {}
+    for spec in specs:
+        m = re.match(r"(\w+)/(\d+)=(.+)$", spec)
+        if not m or m.group(1) not in TYPES or int(m.group(2)) > 0xFFFF:
+            sys.exit("bad asset %s, want TYPE/ID=SOURCE" % spec)
+        key = (TYPES[m.group(1)], int(m.group(2)))
+        if key in assets:
+            sys.exit("%s given twice" % spec.split("=")[0])
+        source = m.group(3)
+        if "@" in source:
+            path, name = source.rsplit("@", 1)
+            data = c_array(path, name)
+        else:
+            with open(source, "rb") as f:
+                data = f.read()
+            name = os.path.basename(source)
+        assets[key] = (name, data)
+
+    index_sectors = max(1, sectors(len(assets) * ENTRY.size))
+    sector = 1 + index_sectors
+    index, payload = [], []
+    for (kind, ident), (name, data) in sorted(assets.items()):
+        comp, stored, slack = RAW, data, 0
+        if allow_rle and len(data) % 2 == 0:
+            packed, need = rle16(data)
+            assert unrle16(packed, len(data)) == data
+            if sectors(len(packed)) < sectors(len(data)):
+                comp, stored, slack = RLE16, packed, need
+        index.append(ENTRY.pack(kind, comp, ident, sector, len(stored),
+                                len(data), slack,
+                                name.encode("ascii", "replace")[:12]))
+        payload.append(stored.ljust(sectors(len(stored)) * SECTOR, b"\0"))
+        sector += sectors(len(stored))
+
+    with open(out, "wb") as f:
+        f.write(HEADER.pack(MAGIC, VERSION, ENTRY.size, len(index), 1,
+                            1 + index_sectors, sector).ljust(SECTOR, b"\0"))
+        f.write(b"".join(index).ljust(index_sectors * SECTOR, b"\0"))
+        for p in payload:
+            f.write(p)
+    print("%s: %d assets, %d sectors" % (out, len(index), sector))
+
+
+def list_pack(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    magic, version, esize, count, first, data_sector, total = \
+        HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION or esize != ENTRY.size:
+        sys.exit("%s is not a version %d pack" % (path, VERSION))
+    names = {v: k for k, v in TYPES.items()}
+    print("%-7s %5s %-12s %5s %8s %8s %6s %6s" %
+          ("type", "id", "name", "comp", "sector", "size", "raw", "slack"))
+    for i in range(count):
+        kind, comp, ident, sector, size, raw, slack, name = \
+            ENTRY.unpack_from(data, first * SECTOR + i * ENTRY.size)
+        print("%-7s %5d %-12s %5s %8d %8d %6d %6d" %
+              (names.get(kind, kind), ident,
+               name.rstrip(b"\0").decode("ascii", "replace"),
+               ("raw", "rle16")[comp], sector, size, raw, slack))
+    print("%d assets, payloads from sector %d, %d sectors" %
+          (count, data_sector, total))
+
+
+def main():
+    args = sys.argv[1:]
+    allow_rle = "--raw" not in args
+    listing = "--list" in args
+    args = [a for a in args if a not in ("--raw", "--list")]
+    if listing and len(args) == 1:
+        list_pack(args[0])
+    elif not listing and len(args) >= 2:
+        build(args[0], args[1:], allow_rle)
+    else:
+        sys.exit(__doc__)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,67 @@
+// Run src/profiler.c on the host and print its per-phase report.
+//
+// Build:  cc -O2 -DHOST_BUILD -Iinclude -o profsim tools/profsim.c
+//             src/profiler.c
+// Usage:  profsim [FRAMES]
+//
+// Plays FRAMES frames (default 600) of a made-up frame loop: every phase
+// of include/profiler.h spins for a known share of a 16.7 ms frame inside
+// its PROF_SCOPE, logic twice as a catch-up frame would. HOST_BUILD makes
+// prof_cycles count nanoseconds, so the report is in ns where the board's
+// is in cycles. Each phase's average over the history ring is printed with
+// the time it was asked to spin, the two should agree to within the
+// scheduling noise of the host.
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "profiler.h"
+
+#define FRAME_NS 16666667u
+
+// Share of the frame in thousandths, in ProfPhase order
+static const uint32_t share[PROF_PHASES] = {120, 10, 200, 60, 20, 40, 300};
+
+static void spin(uint32_t ns) {
+  uint32_t start = prof_cycles();
+  while (prof_cycles() - start < ns)
+    ;
+}
+
+int main(int argc, char **argv) {
+  uint32_t frames = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 600;
+  uint64_t total[PROF_PHASES] = {0};
+  int bad = 0;
+
+  Prof_Init();
+  for (uint32_t f = 0; f < frames; ++f) {
+    for (int p = 0; p < PROF_PHASES; ++p) {
+      uint32_t ns = FRAME_NS / 1000 * share[p];
+      if (p == PROF_LOGIC) { // two catch-up ticks accumulate in one phase
+        PROF_SCOPE(p) spin(ns / 2);
+        PROF_SCOPE(p) spin(ns / 2);
+      } else {
+        PROF_SCOPE(p) spin(ns);
+      }
+    }
+    Prof_FrameEnd();
+    for (int p = 0; p < PROF_PHASES; ++p)
+      total[p] += Prof_Cycles(p, 1);
+  }
+
+  printf("%-6s %10s %10s %10s %7s\n", "phase", "asked_ns", "avg_ns",
+         "last_ns", "err%");
+  for (int p = 0; p < PROF_PHASES; ++p) {
+    uint32_t asked = FRAME_NS / 1000 * share[p];
+    uint32_t avg = Prof_AvgCycles(p);
+    double err = 100.0 * ((double)avg - asked) / asked;
+    printf("%-6s %10u %10u %10u %+6.2f\n", Prof_Name(p), asked, avg,
+           Prof_Cycles(p, 1), err);
+    bad |= err < -1.0 || err > 10.0; // a busy host only ever adds time
+  }
+  printf("%u frames, mean over all: ", frames);
+  for (int p = 0; p < PROF_PHASES; ++p)
+    printf("%s=%llu ", Prof_Name(p),
+           (unsigned long long)(frames ? total[p] / frames : 0));
+  printf("\n");
+  return bad;
+}
@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+"""Attribute a PSAMP dump captured from USART0 to functions.
+
+Usage: psamp_report.py DUMP.txt [firmware.elf]
+
+Symbols come from the riscv-nuclei-elf-objdump shipped next to
+platformio.ini, so no other RISC-V toolchain is needed on the host.
+"""
+import bisect
+import os
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+OBJDUMP = os.path.join(ROOT, "riscv-nuclei-elf-objdump")
+ELF = os.path.join(ROOT, ".pio", "build", "sipeed-longan-nano", "firmware.elf")
+
+
+def load_symbols(elf):
+    out = subprocess.run([OBJDUMP, "-t", elf], capture_output=True,
+                         text=True, check=True).stdout
+    syms = []
+    for line in out.splitlines():
+        parts = line.split()
+        # 08000a3c g     F .text	0000005e main
+        if len(parts) >= 5 and "F" in parts[1:-3]:
+            syms.append((int(parts[0], 16), int(parts[-2], 16), parts[-1]))
+    syms.sort()
+    return syms
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    syms = load_symbols(sys.argv[2] if len(sys.argv) > 2 else ELF)
+    starts = [s[0] for s in syms]
+
+    header, per_func, total = "", {}, 0
+    with open(sys.argv[1]) as f:
+        for line in f:
+            line = line.strip()
+            if line.startswith("PSAMP BEGIN"):
+                header, per_func, total = line, {}, 0
+            elif line.startswith("0x"):
+                pc, count = line.split()
+                pc, count = int(pc, 16), int(count)
+                i = bisect.bisect_right(starts, pc) - 1
+                name = "?"
+                if i >= 0 and pc < syms[i][0] + max(syms[i][1], 1):
+                    name = syms[i][2]
+                per_func[name] = per_func.get(name, 0) + count
+                total += count
+
+    print(header)
+    for name, count in sorted(per_func.items(), key=lambda kv: -kv[1]):
+        print("%6.2f%% %8d  %s" % (100.0 * count / max(total, 1), count, name))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,373 @@
+// Random seeks across a 4 MB asset pack, FAT chain walk against fast seek.
+//
+// Build:  cc -O2 -Iinclude -Iinclude/fatfs -o seekbench tools/seekbench.c
+//             src/pack.c src/fatfs/ff.c src/fatfs/ffseek.c
+//             src/fatfs/diskcache.c
+// Usage:  seekbench [-c SECTORS_PER_CLUSTER] [-f RUN] [-n SEEKS] [-o IMAGE]
+//
+// Builds a FAT16 disk image in memory holding ASSETS.PAK, 4 MB of sprites
+// and RLE16 levels in the layout of tools/pack_assets.py, then reads a
+// sector at random offsets through plain f_lseek and f_fastseek_open. Card reads per seek and host time are
+// printed per megabyte of file offset: the chain walk grows with the
+// offset, fast seek stays flat. -f RUN splits the pack into fragments of
+// RUN clusters with a free cluster between them, as on a card that has
+// seen deletes. Every asset is then loaded once through src/pack.c and
+// checked, as raw sectors when the pack is in one piece and through fast
+// seek otherwise. -o writes the image out, it mounts on Linux as vfat.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pack.h"
+#include "fatfs/diskcache.h"
+
+#define PACK_BYTES (4u << 20)
+#define ROOT_ENTRIES 512
+#define MIN_CLUSTERS 4200 // FatFs takes fewer than 4085 for FAT12
+
+static BYTE *image;
+static DWORD image_sectors;
+static DWORD dev_reads; // mmc_disk_read calls, one card command each
+
+DSTATUS disk_initialize(BYTE drv) { return drv ? STA_NOINIT : 0; }
+
+DSTATUS disk_status(BYTE drv) { return drv ? STA_NOINIT : 0; }
+
+DRESULT disk_ioctl(BYTE drv, BYTE cmd, void *buff) {
+  (void)buff;
+  return drv || cmd != CTRL_SYNC ? RES_PARERR : RES_OK;
+}
+
+DRESULT mmc_disk_read(BYTE drv, BYTE *buff, DWORD sector, UINT count) {
+  if (drv || sector + count > image_sectors)
+    return RES_PARERR;
+  dev_reads++;
+  memcpy(buff, image + (size_t)sector * 512, (size_t)count * 512);
+  return RES_OK;
+}
+
+DRESULT mmc_disk_write(BYTE drv, const BYTE *buff, DWORD sector,
+                       UINT count) {
+  if (drv || sector + count > image_sectors)
+    return RES_PARERR;
+  memcpy(image + (size_t)sector * 512, buff, (size_t)count * 512);
+  return RES_OK;
+}
+
+static void put16(BYTE *p, unsigned v) {
+  p[0] = (BYTE)v;
+  p[1] = (BYTE)(v >> 8);
+}
+
+static void put32(BYTE *p, DWORD v) {
+  put16(p, v & 0xFFFF);
+  put16(p + 2, v >> 16);
+}
+
+// Byte i of an asset once decoded. Levels are tile maps, long runs of
+// one 16-bit tile that PACK_RLE16 shrinks.
+static BYTE expect(const PackEntry *e, uint32_t i) {
+  if (e->type == PACK_LEVEL) {
+    unsigned tile = (i / 2 / (37 + e->id)) * 7 + e->id;
+    return (BYTE)(i & 1 ? tile >> 8 : tile);
+  }
+  return (BYTE)(e->id * 31 + e->type * 7 + i);
+}
+
+// PACK_RLE16 as tools/pack_assets.py writes it, @returns stored bytes
+static uint32_t rle16(BYTE *out, const PackEntry *e, uint32_t *slack) {
+  uint32_t words = e->raw_size / 2, i = 0, o = 0, lit = 0, lit_at = 0;
+  long over = 0;
+
+#define WORD(k) (expect(e, (k) * 2) | expect(e, (k) * 2 + 1) << 8)
+#define FLUSH()                                                                \
+  do {                                                                         \
+    if (lit) {                                                                 \
+      put16(out + lit_at, lit);                                                \
+      if ((long)(i * 2) - (long)o > over)                                      \
+        over = (long)(i * 2) - (long)o;                                        \
+    }                                                                          \
+    lit = 0;                                                                   \
+  } while (0)
+  while (i < words) {
+    uint32_t run = 1;
+    while (i + run < words && run < 0x7FFF && WORD(i + run) == WORD(i))
+      run++;
+    if (run >= 3) {
+      FLUSH();
+      put16(out + o, 0x8000 | run);
+      put16(out + o + 2, WORD(i));
+      o += 4;
+      i += run;
+      if ((long)(i * 2) - (long)o > over)
+        over = (long)(i * 2) - (long)o;
+      continue;
+    }
+    if (!lit || lit == 0x7FFF) {
+      FLUSH();
+      lit_at = o;
+      o += 2;
+    }
+    put16(out + o, WORD(i));
+    o += 2;
+    lit++;
+    i++;
+  }
+  FLUSH();
+#undef FLUSH
+#undef WORD
+  *slack = (uint32_t)over;
+  return o;
+}
+
+// PackHeader in sector 0, the index from sector 1, payloads on sector
+// boundaries: sprites of 1 to 4 KB stored raw, then 32 KB levels in RLE16
+static uint32_t build_pack(BYTE *pack, PackEntry *index, uint32_t max) {
+  uint32_t levels = 16, sprites = max - levels, n, sector;
+  uint32_t index_sectors = (max * sizeof(PackEntry) + 511) / 512;
+
+  sector = 1 + index_sectors;
+  for (n = 0; n < max && (sector + 64) * 512 <= PACK_BYTES; ++n) {
+    PackEntry *e = &index[n];
+    memset(e, 0, sizeof *e);
+    e->type = n < sprites ? PACK_SPRITE : PACK_LEVEL;
+    e->id = n < sprites ? n : n - sprites;
+    e->sector = sector;
+    snprintf(e->name, sizeof e->name, "%s%u",
+             e->type == PACK_LEVEL ? "level" : "sprite", e->id);
+    if (e->type == PACK_LEVEL) {
+      e->raw_size = 32768;
+      e->comp = PACK_RLE16;
+      e->size = rle16(pack + sector * 512, e, &e->slack);
+    } else {
+      e->raw_size = e->size = 1024u << (rand() % 3);
+      for (uint32_t b = 0; b < e->size; ++b)
+        pack[sector * 512 + b] = expect(e, b);
+    }
+    sector += (e->size + 511) / 512;
+  }
+  put32(pack, PACK_MAGIC);
+  put16(pack + 4, PACK_VERSION);
+  put16(pack + 6, sizeof(PackEntry));
+  put32(pack + 8, n);
+  put32(pack + 12, 1);
+  put32(pack + 16, 1 + index_sectors);
+  put32(pack + 20, sector);
+  for (uint32_t i = 0; i < n; ++i) {
+    BYTE *p = pack + 512 + i * sizeof(PackEntry);
+    p[0] = index[i].type;
+    p[1] = index[i].comp;
+    put16(p + 2, index[i].id);
+    put32(p + 4, index[i].sector);
+    put32(p + 8, index[i].size);
+    put32(p + 12, index[i].raw_size);
+    put32(p + 16, index[i].slack);
+    memcpy(p + 20, index[i].name, sizeof index[i].name);
+  }
+  return n;
+}
+
+// FAT16 volume without a partition table, the pack in the root directory
+static int build_image(const BYTE *pack, unsigned spc, unsigned run) {
+  DWORD csize = 512u * spc;
+  DWORD pack_clusters = (PACK_BYTES + csize - 1) / csize;
+  DWORD span = run ? pack_clusters + pack_clusters / run : pack_clusters;
+  DWORD nclst = span + 16 < MIN_CLUSTERS ? MIN_CLUSTERS : span + 16;
+  DWORD fatsz = ((nclst + 2) * 2 + 511) / 512;
+  DWORD fat = 1, root = fat + 2 * fatsz, data = root + ROOT_ENTRIES * 32 / 512;
+  DWORD cl = 2, prev = 0;
+  BYTE *bs, *ent;
+
+  if (nclst > 65524)
+    return 0;
+  image_sectors = data + nclst * spc;
+  image = calloc(image_sectors, 512);
+  if (!image)
+    return 0;
+
+  bs = image;
+  memcpy(bs, "\xEB\x3C\x90MSWIN4.1", 11);
+  put16(bs + 11, 512);
+  bs[13] = (BYTE)spc;
+  put16(bs + 14, 1); // reserved sectors
+  bs[16] = 2;        // FATs
+  put16(bs + 17, ROOT_ENTRIES);
+  if (image_sectors < 0x10000)
+    put16(bs + 19, image_sectors);
+  else
+    put32(bs + 32, image_sectors);
+  bs[21] = 0xF8;
+  put16(bs + 22, fatsz);
+  put16(bs + 24, 63);
+  put16(bs + 26, 255);
+  bs[36] = 0x80;
+  bs[38] = 0x29;
+  put32(bs + 39, 0x12345678);
+  memcpy(bs + 43, "SEEKBENCH  FAT16   ", 19);
+  put16(bs + 510, 0xAA55);
+
+  // FAT: media and end-of-chain markers, then the pack's chain
+  BYTE *f = image + fat * 512;
+  put16(f, 0xFFF8);
+  put16(f + 2, 0xFFFF);
+  for (DWORD i = 0; i < pack_clusters; ++i, ++cl) {
+    if (run && i && i % run == 0)
+      cl++; // leave a hole, the next fragment starts after it
+    if (prev)
+      put16(f + prev * 2, cl);
+    memcpy(image + (data + (cl - 2) * spc) * 512, pack + i * csize,
+           i * csize + csize <= PACK_BYTES ? csize : PACK_BYTES - i * csize);
+    prev = cl;
+  }
+  put16(f + prev * 2, 0xFFFF);
+  memcpy(image + (fat + fatsz) * 512, f, fatsz * 512);
+
+  ent = image + root * 512;
+  memcpy(ent, "ASSETS  PAK", 11);
+  ent[11] = 0x20; // archive
+  put16(ent + 26, 2);
+  put32(ent + 28, PACK_BYTES);
+  return 1;
+}
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+typedef struct {
+  DWORD seeks, reads;
+  double ns;
+} Bucket;
+
+// One sector at each of n random offsets, results per MB of offset
+static int seek_run(FIL *fp, const uint32_t *ofs, uint32_t n, Bucket *b) {
+  static BYTE buf[512];
+  UINT br;
+
+  memset(b, 0, 4 * sizeof *b);
+  for (uint32_t i = 0; i < n; ++i) {
+    Bucket *k = &b[ofs[i] >> 20];
+    DWORD reads = dev_reads;
+    double t = now_ns();
+    if (f_lseek(fp, ofs[i]) != FR_OK ||
+        f_read(fp, buf, sizeof buf, &br) != FR_OK || br != sizeof buf)
+      return 0;
+    k->ns += now_ns() - t;
+    k->reads += dev_reads - reads;
+    k->seeks++;
+  }
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  static BYTE pack[PACK_BYTES], buf[40960], work[512];
+  static PackEntry index[1024];
+  static DWORD big_clmt[FF_CLMT_ITEMS(4096)];
+  unsigned spc = 8, run = 0, seeks = 20000;
+  const char *out = NULL;
+  Bucket plain[4], fast[4];
+  uint32_t *ofs, n, bad = 0;
+  FATFS fs;
+  FIL fil;
+
+  for (int a = 1; a + 1 < argc; a += 2) {
+    if (strcmp(argv[a], "-c") == 0)
+      spc = (unsigned)strtoul(argv[a + 1], NULL, 10);
+    else if (strcmp(argv[a], "-f") == 0)
+      run = (unsigned)strtoul(argv[a + 1], NULL, 10);
+    else if (strcmp(argv[a], "-n") == 0)
+      seeks = (unsigned)strtoul(argv[a + 1], NULL, 10);
+    else if (strcmp(argv[a], "-o") == 0)
+      out = argv[a + 1];
+  }
+  if (!spc || spc > 64 || (spc & (spc - 1)) || !seeks) {
+    fprintf(stderr, "usage: seekbench [-c SECTORS_PER_CLUSTER] [-f RUN] "
+                    "[-n SEEKS] [-o IMAGE]\n");
+    return 2;
+  }
+
+  srand(1);
+  n = build_pack(pack, index, sizeof index / sizeof index[0]);
+  if (!build_image(pack, spc, run)) {
+    fprintf(stderr, "no FAT16 layout for %u sectors per cluster\n", spc);
+    return 1;
+  }
+  if (out) {
+    FILE *f = fopen(out, "wb");
+    if (!f || fwrite(image, 512, image_sectors, f) != image_sectors) {
+      perror(out);
+      return 1;
+    }
+    fclose(f);
+  }
+  if (f_mount(&fs, "", 1) != FR_OK) {
+    fprintf(stderr, "image does not mount\n");
+    return 1;
+  }
+
+  ofs = malloc(seeks * sizeof *ofs);
+  for (uint32_t i = 0; i < seeks; ++i)
+    ofs[i] = (uint32_t)(((uint64_t)rand() << 16 ^ rand()) % (PACK_BYTES - 512));
+
+  if (f_open(&fil, PACK_FILE, FA_READ) != FR_OK ||
+      !seek_run(&fil, ofs, seeks, plain)) {
+    fprintf(stderr, "plain seeks failed\n");
+    return 1;
+  }
+  f_close(&fil);
+  if (f_fastseek_open(&fil, PACK_FILE, big_clmt,
+                      sizeof big_clmt / sizeof big_clmt[0]) != FR_OK ||
+      !seek_run(&fil, ofs, seeks, fast)) {
+    fprintf(stderr, "fast seeks failed\n");
+    return 1;
+  }
+  printf("pack %u KB in %u fragments, %u B clusters, %u assets, CLMT %lu "
+         "bytes\n",
+         PACK_BYTES >> 10, f_fragments(&fil), spc * 512, n,
+         (unsigned long)big_clmt[0] * sizeof(DWORD));
+  f_close(&fil);
+
+  printf("%9s %14s %14s %12s %12s\n", "offset", "plain_reads", "fast_reads",
+         "plain_ns", "fast_ns");
+  for (int k = 0; k < 4; ++k)
+    printf("%6d MB %14.2f %14.2f %12.0f %12.0f\n", k,
+           plain[k].seeks ? (double)plain[k].reads / plain[k].seeks : 0,
+           fast[k].seeks ? (double)fast[k].reads / fast[k].seeks : 0,
+           plain[k].seeks ? plain[k].ns / plain[k].seeks : 0,
+           fast[k].seeks ? fast[k].ns / fast[k].seeks : 0);
+
+  // Every asset once through the pack loader, in random order
+  if (!Pack_Open(&fil, PACK_FILE, work)) {
+    fprintf(stderr, "Pack_Open failed\n");
+    return 1;
+  }
+  DWORD reads = dev_reads;
+  double t = now_ns();
+  for (uint32_t i = 0; i < n; ++i) {
+    const PackEntry *want = &index[rand() % n];
+    PackEntry e;
+    uint32_t got = 0;
+    if (Pack_Find(want->type, want->id, &e) && Pack_LoadSize(&e) <= sizeof buf)
+      got = Pack_Load(&e, buf);
+    if (got != want->raw_size)
+      bad++;
+    for (uint32_t b = 0; b < got && !bad; ++b)
+      bad += buf[b] != expect(want, b);
+  }
+  t = now_ns() - t;
+  printf("Pack_Load x%u: %.2f card reads, %.0f ns each, %u bad, ", n,
+         (double)(dev_reads - reads) / n, t / n, bad);
+  if (Pack_StartSector())
+    printf("raw sectors from LBA %u\n", Pack_StartSector());
+  else
+    printf("through FatFs, %u fragments%s\n", Pack_Fragments(),
+           Pack_Fragments() ? "" : " (chain walk, CLMT too small)");
+  Pack_Close();
+  f_mount(0, "", 0);
+  free(ofs);
+  free(image);
+  return bad != 0;
+}
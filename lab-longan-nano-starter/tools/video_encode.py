@@ -0,0 +1,277 @@
+#!/usr/bin/env python3
+"""Encode a clip for src/video.c.
+
+Usage: video_encode.py [options] IN.RAW OUT.VID
+       video_encode.py --list CLIP.VID
+
+IN.RAW is frames of RGB565, high byte first, row by row, e.g. from
+  ffmpeg -i clip.mp4 -vf scale=160:80 -r 20 -f rawvideo -pix_fmt rgb565be IN.RAW
+
+Options:
+  --size WxH   frame size, default 160x80 (the whole LCD)
+  --fps N      target frame rate, default 20
+  --key N      force a key frame at least every N frames, default 30, 0
+               for only the first; the player catches up by them
+  --raw        key frames only, every frame can be dropped
+  --gap N      unchanged pixels sent along to join two changed stretches
+               of a row, default 6; a new window costs 11 bytes of commands
+  --demo N     write N frames of a test pattern to IN.RAW first
+
+Every frame is checked by decoding it again. The report gives the card
+rate the clip needs at its frame rate and the LCD bytes per frame.
+
+Copy the clip to the card in one piece (a freshly formatted card, or
+after deleting the old one) so Video_Open can read it as raw sectors.
+"""
+import struct
+import sys
+
+SECTOR = 512
+MAGIC = 0x31444956
+VERSION = 1
+HEADER = struct.Struct("<IHHHHHHIIII")  # VideoHeader in include/video.h
+FRAME = struct.Struct("<IHBB")          # VideoFrame
+KEY, DELTA = 0, 1
+LIT, RUN, CONT = 0, 1, 0x80
+MIN_RUN = 4      # equal pixels worth a SPAN_RUN
+MAX_SPAN = 255
+WINDOW_BYTES = 11  # LCD_Address_Set: 3 commands, 8 bytes of coordinates
+SPI_HZ = 13500000  # SPI0 at PCLK2 / 8
+
+
+def sectors(n):
+    return (n + SECTOR - 1) // SECTOR
+
+
+def pieces(row, a, b):
+    """Split pixels row[a:b] into (op, pixels) pieces of at most MAX_SPAN"""
+    out = []
+    lit = a
+    i = a
+    while i < b:
+        j = i + 1
+        while j < b and row[j] == row[i]:
+            j += 1
+        if j - i >= MIN_RUN:
+            for s in range(lit, i, MAX_SPAN):
+                out.append((LIT, row[s:min(i, s + MAX_SPAN)]))
+            for s in range(i, j, MAX_SPAN):
+                out.append((RUN, [row[i]] * (min(j, s + MAX_SPAN) - s)))
+            lit = j
+        i = j
+    for s in range(lit, b, MAX_SPAN):
+        out.append((LIT, row[s:min(b, s + MAX_SPAN)]))
+    return out
+
+
+def stretches(prev, cur, gap):
+    """Changed stretches [a, b) of a row, joined across short gaps"""
+    out = []
+    for x, (p, c) in enumerate(zip(prev, cur)):
+        if p == c:
+            continue
+        if out and x - out[-1][1] <= gap:
+            out[-1][1] = x + 1
+        else:
+            out.append([x, x + 1])
+    return out
+
+
+class SectorWriter:
+    """Packs spans so that none straddles a sector"""
+
+    def __init__(self):
+        self.sectors = []
+        self.cur = bytearray()
+
+    def room(self):
+        return SECTOR - len(self.cur)
+
+    def put(self, span):
+        if len(span) > self.room():
+            self.flush()
+        self.cur += span
+
+    def flush(self):
+        if self.cur:
+            self.sectors.append(bytes(self.cur.ljust(SECTOR, b"\0")))
+        self.cur = bytearray()
+
+    def data(self):
+        self.flush()
+        return b"".join(self.sectors)
+
+
+def px(pixels):
+    return struct.pack(">%dH" % len(pixels), *pixels)
+
+
+def delta(prev, cur, width, height, gap):
+    """@returns the delta frame and the LCD bytes it costs"""
+    w = SectorWriter()
+    lcd = 0
+    for y in range(height):
+        rp = prev[y * width:(y + 1) * width]
+        rc = cur[y * width:(y + 1) * width]
+        for a, b in stretches(rp, rc, gap):
+            lcd += WINDOW_BYTES + 2 * (b - a)
+            x = a
+            for op, pixels in pieces(rc, a, b):
+                flag = CONT if x != a else 0
+                if op == RUN:
+                    w.put(struct.pack("<BBBB", x, y, len(pixels), RUN | flag)
+                          + px(pixels[:1]))
+                    x += len(pixels)
+                    continue
+                # a literal is cut at the end of a sector and goes on
+                while pixels:
+                    n = min(len(pixels), (w.room() - 4) // 2)
+                    if n < 1:
+                        w.flush()
+                        continue
+                    w.put(struct.pack("<BBBB", x, y, n, LIT | flag) +
+                          px(pixels[:n]))
+                    x, pixels, flag = x + n, pixels[n:], CONT
+    return w.data(), lcd
+
+
+def undelta(screen, data, width, height):
+    """Apply a delta frame the way src/video.c does"""
+    pos = None
+    for base in range(0, len(data), SECTOR):
+        i = base
+        while i + 4 <= base + SECTOR and data[i + 2]:
+            x, y, n, op = data[i:i + 4]
+            i += 4
+            if not op & CONT:
+                assert x + n <= width and y < height
+                pos = y * width + x
+            if op & ~CONT == RUN:
+                screen[pos:pos + n] = [struct.unpack_from(">H", data, i)[0]] * n
+                i += 2
+            else:
+                screen[pos:pos + n] = struct.unpack_from(">%dH" % n, data, i)
+                i += 2 * n
+            pos += n
+
+
+def demo(path, count, width, height):
+    """A box bouncing over colour bars that jump every 40 frames, which
+    takes a key frame"""
+    with open(path, "wb") as f:
+        for t in range(count):
+            bx = abs((t * 3) % (2 * (width - 24)) - (width - 24))
+            by = abs((t * 2) % (2 * (height - 24)) - (height - 24))
+            shift = t // 40 * 7
+            rows = []
+            for y in range(height):
+                row = []
+                for x in range(width):
+                    if bx <= x < bx + 24 and by <= y < by + 24:
+                        row.append(0xFFE0 if (x - bx) // 6 % 2 else 0xF800)
+                    else:
+                        band = (x + shift) // 20 % 4
+                        row.append((0x001F, 0x07E0, 0x0010, 0x8430)[band])
+                rows += row
+            f.write(px(rows))
+
+
+def encode(src, out, width, height, fps, key_every, raw, gap):
+    size = width * height * 2
+    with open(src, "rb") as f:
+        data = f.read()
+    if not data or len(data) % size:
+        sys.exit("%s is not whole %dx%d RGB565 frames" % (src, width, height))
+    count = len(data) // size
+    index_sectors = sectors(count * FRAME.size)
+    sector = 1 + index_sectors
+    index, payload = [], []
+    prev = None
+    keys = lcd_total = 0
+    for k in range(count):
+        cur = list(struct.unpack_from(">%dH" % (width * height), data,
+                                      k * size))
+        stored, kind, lcd = None, KEY, size + WINDOW_BYTES
+        forced = raw or prev is None or (key_every and k % key_every == 0)
+        if not forced:
+            d, dl = delta(prev, cur, width, height, gap)
+            if sectors(len(d)) < sectors(size):
+                stored, kind, lcd = d, DELTA, dl
+                check = list(prev)
+                undelta(check, d, width, height)
+                assert check == cur, "frame %d does not decode" % k
+        if stored is None:
+            stored = data[k * size:(k + 1) * size]
+            keys += 1
+        index.append(FRAME.pack(sector, sectors(len(stored)), kind, 0))
+        payload.append(stored.ljust(sectors(len(stored)) * SECTOR, b"\0"))
+        sector += sectors(len(stored))
+        lcd_total += lcd
+        prev = cur
+
+    with open(out, "wb") as f:
+        f.write(HEADER.pack(MAGIC, VERSION, FRAME.size, width, height, fps,
+                            0 if raw else key_every, count, 1,
+                            1 + index_sectors, sector).ljust(SECTOR, b"\0"))
+        f.write(b"".join(index).ljust(index_sectors * SECTOR, b"\0"))
+        for p in payload:
+            f.write(p)
+
+    data_bytes = (sector - 1 - index_sectors) * SECTOR
+    print("%s: %d frames %dx%d at %d fps, %d key, %d delta, %d sectors" %
+          (out, count, width, height, fps, keys, count - keys, sector))
+    print("card: %.1f KB per frame, %.3f MB/s at %d fps (key frames alone "
+          "%.3f MB/s)" % (data_bytes / count / 1024.0,
+                          data_bytes * fps / count / 1e6, fps,
+                          sectors(size) * SECTOR * fps / 1e6))
+    print("lcd: %.1f KB per frame, %.1f ms at %.1f MHz, at most %.1f fps" %
+          (lcd_total / count / 1024.0, lcd_total * 8e3 / count / SPI_HZ,
+           SPI_HZ / 1e6, count * SPI_HZ / 8.0 / lcd_total))
+
+
+def list_clip(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    (magic, version, fsize, width, height, fps, key_every, count, first,
+     data_sector, total) = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION or fsize != FRAME.size:
+        sys.exit("%s is not a version %d clip" % (path, VERSION))
+    print("%dx%d at %d fps, key every %d, %d frames, data from sector %d, "
+          "%d sectors" % (width, height, fps, key_every, count, data_sector,
+                          total))
+    for k in range(count):
+        sector, n, kind, _ = FRAME.unpack_from(data, first * SECTOR +
+                                               k * FRAME.size)
+        print("%5d %-5s %8d %4d" % (k, ("key", "delta")[kind], sector, n))
+
+
+def main():
+    args = sys.argv[1:]
+    opts = {"--size": "160x80", "--fps": "20", "--key": "30", "--gap": "6",
+            "--demo": None}
+    flags = set()
+    rest = []
+    while args:
+        a = args.pop(0)
+        if a in opts and args:
+            opts[a] = args.pop(0)
+        elif a in ("--raw", "--list"):
+            flags.add(a)
+        else:
+            rest.append(a)
+    if "--list" in flags and len(rest) == 1:
+        list_clip(rest[0])
+        return
+    if len(rest) != 2:
+        sys.exit(__doc__)
+    width, height = (int(v) for v in opts["--size"].split("x"))
+    if not (0 < width <= 256 and 0 < height <= 256):
+        sys.exit("frame size is at most 256x256")
+    if opts["--demo"]:
+        demo(rest[0], int(opts["--demo"]), width, height)
+    encode(rest[0], rest[1], width, height, int(opts["--fps"]),
+           int(opts["--key"]), "--raw" in flags, int(opts["--gap"]))
+
+
+if __name__ == "__main__":
+    main()
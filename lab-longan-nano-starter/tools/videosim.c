@@ -0,0 +1,240 @@
+// Play a clip through src/video.c on the host, against a model of the card
+// and the LCD.
+//
+// Build:  cc -O2 -DHOST_BUILD -Iinclude -Iinclude/fatfs -o videosim
+//             tools/videosim.c src/video.c
+// Usage:  videosim [-k KB/s] [-c US] [-F] [-r IN.RAW] CLIP.VID
+//
+// Time is simulated: a card read takes -c US per command (default 300)
+// plus its sectors at -k KB/s (default 1800), the LCD takes its bytes at
+// 13.5 MHz and runs its DMA alongside the card, as on the board. Every
+// frame the player shows is checked against IN.RAW, the encoder's input,
+// if given. -F reads through f_read_at as for a fragmented file instead
+// of raw sectors. Prints the same figures as the VIDEO line on USART0:
+// frames shown and dropped, frames/s and MB/s from the card.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "video.h"
+#include "fatfs/diskio.h"
+#include "lcd/pixels.h"
+
+#define LCD_NS_PER_BYTE (8 * 1000000000ull / 13500000)
+#define WINDOW_BYTES 11 // LCD_Address_Set, polled
+#define RAW_START 100   // LBA the clip pretends to start at
+
+static FILE *clip_file;
+static uint64_t now_ns, lcd_done_ns, read_ns, idle_ns, lcd_wait_ns;
+static uint32_t card_kbps = 1800, cmd_us = 300;
+static int fragmented;
+
+static uint16_t screen[256 * 256];
+static uint32_t win_x1, win_x2, win_y1, win_y2, cur_x, cur_y;
+static int half_pixel = -1; // high byte waiting for its low byte
+
+static const uint8_t *ref; // IN.RAW
+static uint32_t ref_frames;
+static uint32_t checked, mismatches;
+static VideoStats st;
+
+uint32_t Tick_Ms(void) { return (uint32_t)(now_ns / 1000000); }
+
+void delay_1ms(uint32_t count) {
+  uint64_t ms = now_ns / 1000000 + count + 1;
+  idle_ns += ms * 1000000 - now_ns;
+  now_ns = ms * 1000000;
+}
+
+static void card(uint32_t bytes) {
+  uint64_t t = cmd_us * 1000ull + bytes * 1000000ull / card_kbps;
+  now_ns += t;
+  read_ns += t;
+}
+
+DRESULT disk_read(BYTE drv, BYTE *buff, DWORD sector, UINT count) {
+  if (drv || sector < RAW_START ||
+      fseek(clip_file, (long)(sector - RAW_START) * VIDEO_SECTOR, SEEK_SET) ||
+      fread(buff, VIDEO_SECTOR, count, clip_file) != count)
+    return RES_ERROR;
+  card(count * VIDEO_SECTOR);
+  return RES_OK;
+}
+
+FRESULT f_fastseek_open(FIL *fp, const TCHAR *path, DWORD *clmt, UINT items) {
+  (void)clmt, (void)items;
+  memset(fp, 0, sizeof *fp);
+  if (!(clip_file = fopen(path, "rb")))
+    return FR_NO_FILE;
+  fseek(clip_file, 0, SEEK_END);
+  fp->obj.objsize = (FSIZE_t)ftell(clip_file);
+  return FR_OK;
+}
+
+DWORD f_start_sector(FIL *fp) {
+  (void)fp;
+  return fragmented ? 0 : RAW_START;
+}
+
+FRESULT f_read_at(FIL *fp, FSIZE_t ofs, void *buff, UINT btr, UINT *br) {
+  (void)fp;
+  fseek(clip_file, (long)ofs, SEEK_SET);
+  *br = (UINT)fread(buff, 1, btr, clip_file);
+  card(*br);
+  return FR_OK;
+}
+
+FRESULT f_close(FIL *fp) {
+  (void)fp;
+  fclose(clip_file);
+  clip_file = NULL;
+  return FR_OK;
+}
+
+static void lcd_sync(void) {
+  if (lcd_done_ns > now_ns) {
+    lcd_wait_ns += lcd_done_ns - now_ns;
+    now_ns = lcd_done_ns;
+  }
+}
+
+static void lcd_byte(uint8_t b) {
+  if (half_pixel < 0) {
+    half_pixel = b;
+    return;
+  }
+  screen[cur_y * 256 + cur_x] = (uint16_t)(half_pixel << 8 | b);
+  half_pixel = -1;
+  if (cur_x++ == win_x2) {
+    cur_x = win_x1;
+    cur_y = cur_y == win_y2 ? win_y1 : cur_y + 1;
+  }
+}
+
+void LCD_PixelsBegin(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
+  lcd_sync();
+  now_ns += WINDOW_BYTES * LCD_NS_PER_BYTE;
+  win_x1 = cur_x = x1, win_y1 = cur_y = y1;
+  win_x2 = x2, win_y2 = y2;
+  half_pixel = -1;
+}
+
+void LCD_PixelsWrite(const uint8_t *buf, uint32_t len) {
+  lcd_sync();
+  // The bytes land at once, the DMA keeps the bus busy until lcd_done_ns
+  for (uint32_t i = 0; i < len; ++i)
+    lcd_byte(buf[i]);
+  lcd_done_ns = now_ns + len * LCD_NS_PER_BYTE;
+}
+
+void LCD_PixelsFill(uint16_t color, uint32_t count) {
+  lcd_sync();
+  for (uint32_t i = 0; i < count; ++i) {
+    lcd_byte(color >> 8);
+    lcd_byte(color & 0xFF);
+  }
+  now_ns += 2 * count * LCD_NS_PER_BYTE;
+}
+
+void LCD_PixelsWait(void) { lcd_sync(); }
+
+void LCD_PixelsEnd(void) { lcd_sync(); }
+
+static void check_screen(void) {
+  const VideoHeader *h = Video_Header();
+
+  if (!ref || !st.shown || st.last >= ref_frames)
+    return;
+  const uint8_t *p = ref + (size_t)st.last * h->width * h->height * 2;
+  for (uint32_t y = 0; y < h->height; ++y)
+    for (uint32_t x = 0; x < h->width; ++x, p += 2)
+      if (screen[y * 256 + x] != (p[0] << 8 | p[1])) {
+        if (!mismatches++)
+          fprintf(stderr, "frame %u differs at %u,%u\n", st.last, x, y);
+        return;
+      }
+  checked++;
+}
+
+// Polled before every frame: the screen still holds the last one shown
+static int between_frames(void) {
+  check_screen();
+  return 0;
+}
+
+static uint8_t *load(const char *path, size_t *size) {
+  FILE *f = fopen(path, "rb");
+  uint8_t *data;
+  long n;
+
+  if (!f || fseek(f, 0, SEEK_END) || (n = ftell(f)) < 0 ||
+      !(data = malloc((size_t)n + 1)) || fseek(f, 0, SEEK_SET) ||
+      fread(data, 1, (size_t)n, f) != (size_t)n) {
+    perror(path);
+    exit(1);
+  }
+  fclose(f);
+  *size = (size_t)n;
+  return data;
+}
+
+int main(int argc, char **argv) {
+  static uint8_t mem[VIDEO_MEM];
+  const char *raw = NULL;
+  FIL fil;
+  size_t size;
+  int opt, done;
+
+  while ((opt = getopt(argc, argv, "k:c:Fr:")) != -1) {
+    switch (opt) {
+    case 'k':
+      card_kbps = (uint32_t)strtoul(optarg, NULL, 10);
+      break;
+    case 'c':
+      cmd_us = (uint32_t)strtoul(optarg, NULL, 10);
+      break;
+    case 'F':
+      fragmented = 1;
+      break;
+    case 'r':
+      raw = optarg;
+      break;
+    default:
+      optind = argc + 1;
+      break;
+    }
+  }
+  if (optind != argc - 1 || !card_kbps) {
+    fprintf(stderr,
+            "usage: videosim [-k KB/s] [-c US] [-F] [-r IN.RAW] CLIP.VID\n");
+    return 2;
+  }
+  if (!Video_Open(&fil, argv[optind], mem)) {
+    fprintf(stderr, "%s: not a clip\n", argv[optind]);
+    return 1;
+  }
+  const VideoHeader *h = Video_Header();
+  if (raw) {
+    ref = load(raw, &size);
+    ref_frames = (uint32_t)(size / (h->width * h->height * 2));
+  }
+
+  done = Video_Play(between_frames, &st);
+  check_screen();
+  Video_Close();
+
+  printf("VIDEO frames=%u shown=%u dropped=%u late=%u keys=%u sectors=%u "
+         "ms=%u\n",
+         st.frames, st.shown, st.dropped, st.late, st.keys, st.sectors, st.ms);
+  printf("%.1f fps of %u, %.3f MB/s from the card; card %.0f%%, LCD wait "
+         "%.0f%%, idle %.0f%% of %.0f ms\n",
+         st.ms ? st.shown * 1000.0 / st.ms : 0.0, h->fps,
+         st.ms ? st.sectors * (double)VIDEO_SECTOR / st.ms / 1000.0 : 0.0,
+         100.0 * read_ns / now_ns, 100.0 * lcd_wait_ns / now_ns,
+         100.0 * idle_ns / now_ns, now_ns / 1e6);
+  if (ref)
+    printf("checked %u frames against %s, %u differ\n", checked, raw,
+           mismatches);
+  return !done || mismatches;
+}